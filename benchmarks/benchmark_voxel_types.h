@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../world/voxel_data.h"
+
+/**
+ * @brief Register the voxel types VoxelWorld registers, without their textures and models
+ * Terrain generation and meshing only need the names, types and mesh styles
+ */
+inline void addBenchmarkVoxelTypes(VoxelDataManager& voxelData)
+{
+    struct Type {
+        const char* name;
+        VoxelType type;
+        VoxelMeshStyle meshStyle;
+        bool collidable;
+    };
+    const Type types[] = {
+        {"air", VoxelType::Gas, VoxelMeshStyle::None, false},
+        {"stone", VoxelType::Solid, VoxelMeshStyle::Voxel, true},
+        {"grass", VoxelType::Solid, VoxelMeshStyle::Voxel, true},
+        {"dirt", VoxelType::Solid, VoxelMeshStyle::Voxel, true},
+        {"sand", VoxelType::Solid, VoxelMeshStyle::Voxel, true},
+        {"water", VoxelType::Fluid, VoxelMeshStyle::Voxel, false},
+        {"flower", VoxelType::Flora, VoxelMeshStyle::Cross, false},
+    };
+    for (const Type& type : types) {
+        VoxelData data;
+        data.name = type.name;
+        data.type = type.type;
+        data.meshStyle = type.meshStyle;
+        data.isCollidable = type.collidable;
+        voxelData.addVoxelData(data);
+    }
+    voxelData.initCommonVoxelTypes();
+}
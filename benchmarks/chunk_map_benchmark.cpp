@@ -0,0 +1,160 @@
+// Compares chunk lookup and insert throughput of the chunk maps
+// Usage: chunk_map_benchmark [lookups per size]
+
+#include "../world/chunk_manager.h"
+#include "../world/flat_chunk_map.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // The hash ChunkPositionMap used before FlatChunkMap, kept for comparison
+    struct XorChunkPositionHash {
+        std::size_t operator()(const ChunkPosition& position) const
+        {
+            return (position.x * 88339) ^ (position.y * 91967) ^ (position.z * 126323);
+        }
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double millisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /**
+     * @brief Positions of a square world of columns, 8 chunks high like generated terrain
+     */
+    std::vector<ChunkPosition> worldPositions(int chunkCount)
+    {
+        const int height = 8;
+        int columns = chunkCount / height;
+        int side = static_cast<int>(std::sqrt(static_cast<double>(columns)));
+        std::vector<ChunkPosition> positions;
+        for (int i = 0; i < columns; i++) {
+            int x = i % side - side / 2;
+            int z = i / side - side / 2;
+            for (int y = 0; y < height; y++) {
+                positions.emplace_back(x, y, z);
+            }
+        }
+        return positions;
+    }
+
+    struct Result {
+        double insertMs;
+        double hitMs;
+        double missMs;
+        u64 checksum;
+    };
+
+    // Maps compared through the same three operations
+    template <typename Map>
+    struct StdMapAdapter {
+        Map map;
+        ChunkManager& manager;
+
+        void insert(const ChunkPosition& position)
+        {
+            map.emplace(std::piecewise_construct, std::forward_as_tuple(position),
+                        std::forward_as_tuple(manager, position));
+        }
+
+        const Chunk* find(const ChunkPosition& position) const
+        {
+            auto itr = map.find(position);
+            return itr == map.end() ? nullptr : &itr->second;
+        }
+    };
+
+    struct FlatMapAdapter {
+        FlatChunkMap<Chunk> map;
+        ChunkManager& manager;
+
+        void insert(const ChunkPosition& position)
+        {
+            map.tryEmplace(position, manager, position);
+        }
+
+        const Chunk* find(const ChunkPosition& position) const
+        {
+            return map.find(position);
+        }
+    };
+
+    template <typename Adapter>
+    Result run(Adapter& adapter, const std::vector<ChunkPosition>& positions,
+               const std::vector<ChunkPosition>& hits, const std::vector<ChunkPosition>& misses)
+    {
+        Result result{};
+        auto start = Clock::now();
+        for (const ChunkPosition& position : positions) {
+            adapter.insert(position);
+        }
+        result.insertMs = millisecondsSince(start);
+
+        start = Clock::now();
+        for (const ChunkPosition& position : hits) {
+            const Chunk* chunk = adapter.find(position);
+            result.checksum += chunk ? static_cast<u64>(chunk->getPosition().y) : 0;
+        }
+        result.hitMs = millisecondsSince(start);
+
+        start = Clock::now();
+        for (const ChunkPosition& position : misses) {
+            result.checksum += adapter.find(position) ? 1 : 0;
+        }
+        result.missMs = millisecondsSince(start);
+        return result;
+    }
+
+    void print(const char* name, const Result& result, std::size_t inserts, std::size_t lookups)
+    {
+        std::printf("  %-28s insert %7.2f M/s   hit %7.2f M/s   miss %7.2f M/s   (checksum %llu)\n",
+                    name, inserts / result.insertMs / 1000.0, lookups / result.hitMs / 1000.0,
+                    lookups / result.missMs / 1000.0,
+                    static_cast<unsigned long long>(result.checksum));
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t lookups = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000000;
+    ChunkManager manager;
+    std::mt19937 random(1234);
+
+    for (int chunkCount : {10000, 30000, 100000}) {
+        std::vector<ChunkPosition> positions = worldPositions(chunkCount);
+
+        // Hits in random order, misses just above the world where no chunks are
+        std::vector<ChunkPosition> hits(lookups);
+        std::vector<ChunkPosition> misses(lookups);
+        for (std::size_t i = 0; i < lookups; i++) {
+            const ChunkPosition& position = positions[random() % positions.size()];
+            hits[i] = position;
+            misses[i] = {position.x, position.y + 8, position.z};
+        }
+        std::shuffle(positions.begin(), positions.end(), random);
+
+        std::printf("%zu chunks, %zu lookups\n", positions.size(), lookups);
+        {
+            StdMapAdapter<std::unordered_map<ChunkPosition, Chunk, XorChunkPositionHash>> map{{}, manager};
+            print("unordered_map, xor hash", run(map, positions, hits, misses), positions.size(), lookups);
+        }
+        {
+            StdMapAdapter<std::unordered_map<ChunkPosition, Chunk, ChunkPositionHash>> map{{}, manager};
+            print("unordered_map, mixed hash", run(map, positions, hits, misses), positions.size(), lookups);
+        }
+        {
+            FlatMapAdapter map{{}, manager};
+            print("FlatChunkMap", run(map, positions, hits, misses), positions.size(), lookups);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Measures voxel raycast throughput over generated terrain
+// Usage: raycast_benchmark [rays]
+
+#include "../world/chunk_manager.h"
+#include "../world/terrain_generation.h"
+#include "../world/voxel_data.h"
+#include "../world/voxel_raycast.h"
+#include "benchmark_voxel_types.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double millisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Result {
+        double milliseconds;
+        std::size_t hits;
+        double checksum;
+    };
+
+    Result castEach(const ChunkManager& chunkManager, const std::vector<VoxelRay>& rays,
+                    const VoxelRayFilter& filter)
+    {
+        Result result{};
+        auto start = Clock::now();
+        for (const VoxelRay& ray : rays) {
+            VoxelRayHit hit =
+                raycastVoxels(chunkManager, ray.origin, ray.direction, ray.maxDistance, filter);
+            result.hits += hit.hit ? 1 : 0;
+            result.checksum += hit.distance;
+        }
+        result.milliseconds = millisecondsSince(start);
+        return result;
+    }
+
+    Result castBatch(const ChunkManager& chunkManager, const std::vector<VoxelRay>& rays,
+                     const VoxelRayFilter& filter)
+    {
+        Result result{};
+        std::vector<VoxelRayHit> hits;
+        auto start = Clock::now();
+        raycastVoxels(chunkManager, rays, filter, hits);
+        result.milliseconds = millisecondsSince(start);
+        for (const VoxelRayHit& hit : hits) {
+            result.hits += hit.hit ? 1 : 0;
+            result.checksum += hit.distance;
+        }
+        return result;
+    }
+
+    void print(const char* name, const Result& result, std::size_t rays)
+    {
+        std::printf("  %-28s %8.2f M rays/s   hits %5.1f%%   (checksum %.1f)\n", name,
+                    rays / result.milliseconds / 1000.0, 100.0 * result.hits / rays,
+                    result.checksum);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t rayCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int radius = 8;
+    const int seed = 12345;
+    const int worldSize = 64;
+    // The island the terrain generator makes is in the middle of the world
+    const int centre = worldSize / 2;
+
+    // Terrain generation reports progress on stdout
+    std::cout.setstate(std::ios::failbit);
+    VoxelDataManager voxelData;
+    addBenchmarkVoxelTypes(voxelData);
+    ChunkManager chunkManager;
+    for (int x = centre - radius; x <= centre + radius; x++) {
+        for (int z = centre - radius; z <= centre + radius; z++) {
+            generateTerrain(chunkManager, x, z, voxelData, seed, worldSize);
+        }
+    }
+    std::cout.clear();
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    const float middle = centre * CHUNK_SIZE;
+    const float extent = radius * CHUNK_SIZE * 0.75f;
+
+    // Rays start at eye height above whatever is at the surface, water included
+    VoxelRayFilter surface = VoxelRayFilter::notAir();
+    auto randomEye = [&]() {
+        glm::vec3 eye{middle + unit(random) * extent, 256.0f, middle + unit(random) * extent};
+        VoxelRayHit ground = raycastVoxels(chunkManager, eye, {0.0f, -1.0f, 0.0f}, 512.0f, surface);
+        eye.y = ground.hit ? ground.voxel.y + 2.6f : 32.0f;
+        return eye;
+    };
+
+    // Block picking: looking around and down, 8 voxels reach
+    std::vector<VoxelRay> picks(rayCount);
+    for (VoxelRay& ray : picks) {
+        ray.origin = randomEye();
+        ray.direction = {unit(random), unit(random) - 0.5f, unit(random)};
+        ray.maxDistance = 8.0f;
+    }
+
+    // Line of sight: to a point up to 45 voxels away, a few voxels above or below
+    std::vector<VoxelRay> sightLines(rayCount);
+    for (VoxelRay& ray : sightLines) {
+        glm::vec3 from = randomEye();
+        glm::vec3 to = from + glm::vec3{unit(random), unit(random) * 0.25f, unit(random)} * 45.0f;
+        ray.origin = from;
+        ray.direction = to - from;
+        ray.maxDistance = glm::length(to - from);
+    }
+
+    VoxelRayFilter solid = VoxelRayFilter::ofTypes(voxelData, {VoxelType::Solid, VoxelType::Flora});
+    VoxelRayFilter collidable = VoxelRayFilter::collidable(voxelData);
+
+    std::printf("%zu chunks, %zu rays\n", chunkManager.chunks().size(), rayCount);
+    print("pick, one call per ray", castEach(chunkManager, picks, solid), rayCount);
+    print("pick, batched", castBatch(chunkManager, picks, solid), rayCount);
+    print("line of sight, one per ray", castEach(chunkManager, sightLines, collidable), rayCount);
+    print("line of sight, batched", castBatch(chunkManager, sightLines, collidable), rayCount);
+    return 0;
+}
@@ -0,0 +1,431 @@
+// Times terrain generation, chunk meshing, voxel access and voxel compression without a
+// window or GL context, and writes the results as JSON
+// Heap allocations are counted too, and meshing must make none once its buffers have grown
+// Usage: world_benchmark [radius in columns] [output file, default stdout]
+
+#include "../world/chunk.h"
+#include "../world/chunk_manager.h"
+#include "../world/chunk_mesher.h"
+#include "../world/terrain_generation.h"
+#include "../world/voxel_data.h"
+#include "benchmark_voxel_types.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+    // Every heap allocation of the process, counted by the operator new overloads below
+    std::atomic<u64> allocationCount{0};
+
+    // Alignment of the overloads without std::align_val_t, which use malloc
+    constexpr std::size_t DEFAULT_ALIGNMENT = 0;
+
+    void* countedAllocate(std::size_t size, std::size_t alignment) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0) {
+            size = 1;
+        }
+        if (alignment == DEFAULT_ALIGNMENT) {
+            return std::malloc(size);
+        }
+#ifdef _WIN32
+        return _aligned_malloc(size, alignment);
+#else
+        // aligned_alloc needs the size to be a multiple of the alignment
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void* countedAllocateOrThrow(std::size_t size, std::size_t alignment)
+    {
+        if (void* memory = countedAllocate(size, alignment)) {
+            return memory;
+        }
+        throw std::bad_alloc();
+    }
+
+    // Memory from the std::align_val_t overloads, which Windows frees separately
+    void freeAligned(void* memory) noexcept
+    {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+} // namespace
+
+// Every replaceable form is overridden, so none of them bypasses the counter or frees
+// memory it did not allocate
+void* operator new(std::size_t size)
+{
+    return countedAllocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+    freeAligned(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(memory);
+}
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double nanosecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    /**
+     * @brief Timings of one operation, summarised for the JSON output
+     * The checksum is derived from what the operation produced, so a change in
+     * behaviour shows up next to a change in speed
+     */
+    struct Result {
+        Result(std::string name, std::string unit) : name(std::move(name)), unit(std::move(unit))
+        {
+        }
+
+        std::string name;
+        std::string unit;
+        std::vector<double> samples;
+        u64 checksum = 0;
+        // Heap allocations made by the timed code, over all samples
+        u64 allocations = 0;
+    };
+
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        std::size_t index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+
+    void writeResult(std::FILE* out, const Result& result, bool last)
+    {
+        std::vector<double> sorted = result.samples;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double sample : sorted) {
+            sum += sample;
+        }
+        std::fprintf(out,
+                     "    {\"name\": \"%s\", \"unit\": \"%s\", \"count\": %zu, \"mean\": %.4f, "
+                     "\"median\": %.4f, \"p95\": %.4f, \"min\": %.4f, \"max\": %.4f, "
+                     "\"allocations\": %.4f, \"checksum\": %llu}%s\n",
+                     result.name.c_str(), result.unit.c_str(), sorted.size(),
+                     sorted.empty() ? 0.0 : sum / sorted.size(),
+                     sorted.empty() ? 0.0 : percentile(sorted, 0.5),
+                     sorted.empty() ? 0.0 : percentile(sorted, 0.95),
+                     sorted.empty() ? 0.0 : sorted.front(), sorted.empty() ? 0.0 : sorted.back(),
+                     sorted.empty() ? 0.0 : static_cast<double>(result.allocations) / sorted.size(),
+                     static_cast<unsigned long long>(result.checksum), last ? "" : ",");
+    }
+
+    const char* meshingModeName(VoxelMeshingMode mode)
+    {
+        return mode == VoxelMeshingMode::Greedy ? "greedy" : "per_face";
+    }
+
+    const char* faceCullingModeName(FaceCullingMode mode)
+    {
+        return mode == FaceCullingMode::Bitmask ? "bitmask" : "per_voxel";
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int radius = 4;
+    if (argc > 1) {
+        char* end = nullptr;
+        errno = 0;
+        const long value = std::strtol(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || errno == ERANGE || value < 0 || value > 1024) {
+            std::cerr << "Usage: world_benchmark [radius in columns, 0 to 1024] [output file, default stdout]\n";
+            return 1;
+        }
+        radius = static_cast<int>(value);
+    }
+    const char* outputPath = argc > 2 ? argv[2] : nullptr;
+    const int seed = 12345;
+    const int worldSize = 64;
+    // The island the terrain generator makes is in the middle of the world
+    const int centre = worldSize / 2;
+
+    // Terrain generation reports progress on stdout, which may be where the JSON goes
+    std::cout.setstate(std::ios::failbit);
+
+    VoxelDataManager voxelData;
+    addBenchmarkVoxelTypes(voxelData);
+    ChunkManager chunkManager;
+    std::vector<Result> results;
+
+    // Terrain generation, one sample per column
+    Result generation{"generate_column", "ms"};
+    std::vector<ChunkPosition> generated;
+    for (int x = centre - radius; x <= centre + radius; x++) {
+        for (int z = centre - radius; z <= centre + radius; z++) {
+            u64 allocations = allocationCount;
+            auto start = Clock::now();
+            std::vector<ChunkPosition> column =
+                generateTerrain(chunkManager, x, z, voxelData, seed, worldSize);
+            double elapsed = nanosecondsSince(start);
+            generation.allocations += allocationCount - allocations;
+            generation.samples.push_back(elapsed / 1e6);
+            generated.insert(generated.end(), column.begin(), column.end());
+        }
+    }
+    generation.checksum = generated.size();
+    results.push_back(std::move(generation));
+
+    // Copies of each chunk and its neighbours, what meshing reads
+    Result snapshotting{"snapshot_chunk", "us"};
+    std::vector<std::unique_ptr<ChunkMeshSnapshot>> snapshots;
+    for (const ChunkPosition& position : generated) {
+        u64 allocations = allocationCount;
+        auto start = Clock::now();
+        auto snapshot = createChunkMeshSnapshot(chunkManager, position);
+        double elapsed = nanosecondsSince(start);
+        snapshotting.allocations += allocationCount - allocations;
+        snapshotting.samples.push_back(elapsed / 1e3);
+        snapshots.push_back(std::move(snapshot));
+    }
+    snapshotting.checksum = snapshots.size();
+    results.push_back(std::move(snapshotting));
+
+    // Meshing of the generated chunks into buffers that are reused from chunk to chunk,
+    // after one untimed pass over every chunk so the buffers have grown to fit
+    const BlockModelMap blockModels;
+    u64 meshingAllocations = 0;
+    ChunkMeshData data;
+    for (VoxelMeshingMode meshingMode : {VoxelMeshingMode::PerFace, VoxelMeshingMode::Greedy}) {
+        for (FaceCullingMode cullingMode : {FaceCullingMode::PerVoxel, FaceCullingMode::Bitmask}) {
+            Result meshing{std::string("mesh_chunk/") + meshingModeName(meshingMode) + "/" +
+                               faceCullingModeName(cullingMode),
+                           "us"};
+            ChunkMesher mesher(voxelData, blockModels, meshingMode, cullingMode);
+            for (const auto& snapshot : snapshots) {
+                mesher.build(*snapshot, data);
+            }
+            for (const auto& snapshot : snapshots) {
+                u64 allocations = allocationCount;
+                auto start = Clock::now();
+                mesher.build(*snapshot, data);
+                double elapsed = nanosecondsSince(start);
+                meshing.allocations += allocationCount - allocations;
+                meshing.samples.push_back(elapsed / 1e3);
+                meshing.checksum += data.indices.size();
+            }
+            meshingAllocations += meshing.allocations;
+            results.push_back(std::move(meshing));
+        }
+    }
+
+    // Voxel access over the generated columns, from the bottom of the world to above the terrain
+    const int minX = (centre - radius) * CHUNK_SIZE;
+    const int minZ = (centre - radius) * CHUNK_SIZE;
+    const int width = (radius * 2 + 1) * CHUNK_SIZE;
+    const int height = 4 * CHUNK_SIZE;
+
+    // Batches of random positions, one sample per batch in nanoseconds per call
+    Result randomAccess{"get_voxel/random", "ns"};
+    std::mt19937 random(1234);
+    const int batchSize = 1 << 16;
+    std::vector<VoxelPosition> positions(batchSize);
+    for (int batch = 0; batch < 32; batch++) {
+        for (VoxelPosition& position : positions) {
+            position = {minX + static_cast<int>(random() % width),
+                        static_cast<int>(random() % height),
+                        minZ + static_cast<int>(random() % width)};
+        }
+        u64 allocations = allocationCount;
+        auto start = Clock::now();
+        for (const VoxelPosition& position : positions) {
+            randomAccess.checksum += chunkManager.getVoxel(position);
+        }
+        double elapsed = nanosecondsSince(start);
+        randomAccess.allocations += allocationCount - allocations;
+        randomAccess.samples.push_back(elapsed / batchSize);
+    }
+    results.push_back(std::move(randomAccess));
+
+    // Every voxel of one column at a time, x fastest like the chunk layout
+    Result sequentialAccess{"get_voxel/sequential", "ns"};
+    for (int columnX = 0; columnX < width; columnX += CHUNK_SIZE) {
+        for (int columnZ = 0; columnZ < width; columnZ += CHUNK_SIZE) {
+            u64 allocations = allocationCount;
+            auto start = Clock::now();
+            for (int y = 0; y < height; y++) {
+                for (int z = 0; z < CHUNK_SIZE; z++) {
+                    for (int x = 0; x < CHUNK_SIZE; x++) {
+                        sequentialAccess.checksum += chunkManager.getVoxel(
+                            {minX + columnX + x, y, minZ + columnZ + z});
+                    }
+                }
+            }
+            double elapsed = nanosecondsSince(start);
+            sequentialAccess.allocations += allocationCount - allocations;
+            sequentialAccess.samples.push_back(elapsed / (height * CHUNK_SIZE * CHUNK_SIZE));
+        }
+    }
+    results.push_back(std::move(sequentialAccess));
+
+    // Compression round trips of the generated chunks, one sample per chunk
+    Result compression{"compress_voxels", "us"};
+    Result decompression{"decompress_voxels", "us"};
+    VoxelArray voxels;
+    int mismatches = 0;
+    for (const ChunkPosition& position : generated) {
+        chunkManager.findChunk(position)->copyVoxels(voxels);
+
+        u64 allocations = allocationCount;
+        auto start = Clock::now();
+        CompressedVoxels compressed = compressVoxelData(voxels);
+        double elapsed = nanosecondsSince(start);
+        compression.allocations += allocationCount - allocations;
+        compression.samples.push_back(elapsed / 1e3);
+        compression.checksum += compressed.size();
+
+        allocations = allocationCount;
+        start = Clock::now();
+        VoxelArray decompressed = decompressVoxelData(compressed);
+        elapsed = nanosecondsSince(start);
+        decompression.allocations += allocationCount - allocations;
+        decompression.samples.push_back(elapsed / 1e3);
+        for (voxel_t voxel : decompressed) {
+            decompression.checksum += voxel;
+        }
+        mismatches += decompressed != voxels;
+    }
+    results.push_back(std::move(compression));
+    results.push_back(std::move(decompression));
+
+    std::FILE* out = outputPath ? std::fopen(outputPath, "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "ERROR::BENCHMARK::OUTPUT_NOT_OPENED %s\n", outputPath);
+        return 1;
+    }
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"benchmark\": \"world\",\n");
+    std::fprintf(out, "  \"seed\": %d,\n  \"worldSize\": %d,\n  \"radius\": %d,\n", seed, worldSize,
+                 radius);
+    std::fprintf(out, "  \"chunks\": %zu,\n", chunkManager.chunks().size());
+    std::fprintf(out, "  \"compressionMismatches\": %d,\n", mismatches);
+    std::fprintf(out, "  \"meshingAllocations\": %llu,\n",
+                 static_cast<unsigned long long>(meshingAllocations));
+    std::fprintf(out, "  \"results\": [\n");
+    for (std::size_t i = 0; i < results.size(); i++) {
+        writeResult(out, results[i], i + 1 == results.size());
+    }
+    std::fprintf(out, "  ]\n}\n");
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    // A broken round trip, or meshing that allocates once warmed up, fails the run
+    return mismatches == 0 && meshingAllocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#include "block_texture_array.h"
+
+#include "world/packed_vertex.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace {
+    constexpr int LAYER_BYTES = BlockTextureArray::LAYER_SIZE * BlockTextureArray::LAYER_SIZE * 4;
+
+    /**
+     * @brief Scale an RGBA image to one layer
+     * Each layer pixel averages the image pixels it covers, or takes the nearest one when
+     * the image is smaller, so pixel art stays sharp and large images don't alias
+     */
+    void resample(const unsigned char* pixels, int width, int height, unsigned char* layer)
+    {
+        const int size = BlockTextureArray::LAYER_SIZE;
+        for (int y = 0; y < size; y++) {
+            int y0 = y * height / size;
+            int y1 = std::max((y + 1) * height / size, y0 + 1);
+            for (int x = 0; x < size; x++) {
+                int x0 = x * width / size;
+                int x1 = std::max((x + 1) * width / size, x0 + 1);
+
+                unsigned int sum[4] = {0, 0, 0, 0};
+                for (int sy = y0; sy < y1; sy++) {
+                    for (int sx = x0; sx < x1; sx++) {
+                        const unsigned char* pixel = &pixels[(sy * width + sx) * 4];
+                        for (int c = 0; c < 4; c++) {
+                            sum[c] += pixel[c];
+                        }
+                    }
+                }
+                unsigned int count = (y1 - y0) * (x1 - x0);
+                for (int c = 0; c < 4; c++) {
+                    layer[(y * size + x) * 4 + c] = static_cast<unsigned char>(sum[c] / count);
+                }
+            }
+        }
+    }
+
+    void fillMissingTexture(unsigned char* layer)
+    {
+        const int size = BlockTextureArray::LAYER_SIZE;
+        const int square = size / 8;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                bool magenta = (x / square + y / square) % 2 == 0;
+                unsigned char* pixel = &layer[(y * size + x) * 4];
+                pixel[0] = magenta ? 255 : 0;
+                pixel[1] = 0;
+                pixel[2] = magenta ? 255 : 0;
+                pixel[3] = 255;
+            }
+        }
+    }
+} // namespace
+
+BlockTextureArray::BlockTextureArray() : m_texture(0), m_layerCount(0) {}
+
+BlockTextureArray::~BlockTextureArray() {
+    if (m_texture != 0) {
+        glDeleteTextures(1, &m_texture);
+    }
+}
+
+int BlockTextureArray::load(const std::string& directory) {
+    namespace fs = std::filesystem;
+
+    // Sorted so layers keep their numbers from run to run
+    std::vector<fs::path> images;
+    std::error_code error;
+    for (const fs::directory_entry& block : fs::directory_iterator(directory, error)) {
+        if (!block.is_directory(error)) continue;
+        for (const fs::directory_entry& file : fs::directory_iterator(block.path(), error)) {
+            if (file.is_regular_file(error) && file.path().extension() == ".png") {
+                images.push_back(file.path());
+            }
+        }
+    }
+    if (error) {
+        std::cerr << "ERROR::BLOCK_TEXTURES::DIRECTORY_NOT_READ " << directory << ": " << error.message() << std::endl;
+    }
+    std::sort(images.begin(), images.end());
+
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    const std::size_t layerLimit = std::min<std::size_t>(std::max(maxLayers, 1), MAX_TEXTURE_LAYERS);
+
+    std::vector<unsigned char> pixels(LAYER_BYTES);
+    fillMissingTexture(pixels.data());
+    m_layers.clear();
+
+    // Textures are addressed with V going up, like the block models' textures
+    stbi_set_flip_vertically_on_load(true);
+    for (const fs::path& path : images) {
+        std::string name = path.stem().string();
+        if (m_layers.count(name) != 0) {
+            std::cerr << "ERROR::BLOCK_TEXTURES::DUPLICATE_NAME " << path.string() << std::endl;
+            continue;
+        }
+        if (m_layers.size() + 1 >= layerLimit) {
+            std::cerr << "ERROR::BLOCK_TEXTURES::TOO_MANY_LAYERS " << path.string() << std::endl;
+            break;
+        }
+
+        int width, height, components;
+        unsigned char* image = stbi_load(path.string().c_str(), &width, &height, &components, 4);
+        if (!image) {
+            std::cerr << "ERROR::BLOCK_TEXTURES::IMAGE_NOT_LOADED " << path.string() << std::endl;
+            continue;
+        }
+        std::size_t offset = pixels.size();
+        pixels.resize(offset + LAYER_BYTES);
+        resample(image, width, height, &pixels[offset]);
+        stbi_image_free(image);
+
+        m_layers[name] = static_cast<u32>(offset / LAYER_BYTES);
+    }
+    m_layerCount = static_cast<int>(pixels.size() / LAYER_BYTES);
+
+    if (m_texture == 0) {
+        glGenTextures(1, &m_texture);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, LAYER_SIZE, LAYER_SIZE, m_layerCount, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    // Merged faces repeat their texture once per voxel
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    std::cout << "Loaded " << m_layers.size() << " block textures from " << directory << std::endl;
+    return m_layerCount;
+}
+
+u32 BlockTextureArray::layer(const std::string& name) const {
+    auto it = m_layers.find(name);
+    return it == m_layers.end() ? 0 : it->second;
+}
+
+void BlockTextureArray::bind(int textureUnit) const {
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+int BlockTextureArray::layerCount() const {
+    return m_layerCount;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "types.h"
+#include <glad/glad.h>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Every block texture in one GL_TEXTURE_2D_ARRAY, so the whole world draws with one bind
+ * Each PNG found in a subdirectory of the texture directory becomes a layer named after its
+ * file, eg models/grass block/grass.png is "grass". Images of any size are resampled to
+ * LAYER_SIZE. Layer 0 is a checkerboard, used for names that have no image.
+ * The texture is created by load, so a GL context must be current.
+ */
+class BlockTextureArray {
+public:
+    // Width and height of every layer
+    static constexpr int LAYER_SIZE = 64;
+
+    BlockTextureArray();
+    ~BlockTextureArray();
+
+    BlockTextureArray(const BlockTextureArray&) = delete;
+    BlockTextureArray& operator=(const BlockTextureArray&) = delete;
+
+    /**
+     * @brief Build the array from the PNGs in the subdirectories of a directory
+     * @param directory Directory holding a subdirectory per block, eg "models"
+     * @return The number of layers, including the fallback layer
+     */
+    int load(const std::string& directory);
+
+    /**
+     * @brief Layer of a texture
+     * @param name Texture name, the image's file name without its extension
+     * @return The layer, or the fallback layer 0 if no image has that name
+     */
+    u32 layer(const std::string& name) const;
+
+    /**
+     * @brief Bind the array to a texture unit, leaving unit 0 active
+     * @param textureUnit Unit for the shader's blockTextures sampler
+     */
+    void bind(int textureUnit) const;
+
+    int layerCount() const;
+
+private:
+    GLuint m_texture;
+    int m_layerCount;
+    std::unordered_map<std::string, u32> m_layers;
+};
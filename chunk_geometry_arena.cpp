@@ -0,0 +1,163 @@
+#include "chunk_geometry_arena.h"
+
+#include <algorithm>
+
+namespace {
+    // Capacity of the buffers when they are first created
+    constexpr u32 INITIAL_PAGES = 1024;
+    constexpr u32 INITIAL_INDICES = 256 * 1024;
+
+    constexpr std::size_t PAGE_BYTES = ChunkGeometryArena::PAGE_VERTICES * sizeof(PackedVoxelVertex);
+}
+
+ChunkGeometryArena::ChunkGeometryArena()
+    : m_vao(0), m_vertexBuffer(0), m_indexBuffer(0), m_originBuffer(0), m_originTexture(0) {}
+
+ChunkGeometryArena::~ChunkGeometryArena() {
+    if (m_vao == 0) return;
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteBuffers(1, &m_vertexBuffer);
+    glDeleteBuffers(1, &m_indexBuffer);
+    glDeleteBuffers(1, &m_originBuffer);
+    glDeleteTextures(1, &m_originTexture);
+}
+
+ChunkGeometryArena::Allocation ChunkGeometryArena::allocate(
+    const std::vector<PackedVoxelVertex>& vertices, const std::vector<unsigned int>& indices,
+    const glm::vec3& origin) {
+    Allocation allocation;
+    if (indices.empty()) return allocation;
+
+    u32 pageCount = static_cast<u32>((vertices.size() + PAGE_VERTICES - 1) / PAGE_VERTICES);
+    u32 indexCount = static_cast<u32>(indices.size());
+
+    u32 firstPage = m_pages.allocate(pageCount);
+    u32 firstIndex = m_indices.allocate(indexCount);
+    if (firstPage == RangeAllocator::INVALID_OFFSET || firstIndex == RangeAllocator::INVALID_OFFSET) {
+        // Give back whichever succeeded, grow, and try again in the larger buffers
+        if (firstPage != RangeAllocator::INVALID_OFFSET) m_pages.release(firstPage, pageCount);
+        if (firstIndex != RangeAllocator::INVALID_OFFSET) m_indices.release(firstIndex, indexCount);
+        reserve(std::max(m_pages.capacity() * 2, m_pages.capacity() + pageCount),
+                std::max(m_indices.capacity() * 2, m_indices.capacity() + indexCount));
+        firstPage = m_pages.allocate(pageCount);
+        firstIndex = m_indices.allocate(indexCount);
+    }
+
+    allocation.firstPage = firstPage;
+    allocation.pageCount = pageCount;
+    allocation.firstIndex = firstIndex;
+    allocation.indexCount = indexCount;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, firstPage * PAGE_BYTES,
+                    vertices.size() * sizeof(PackedVoxelVertex), vertices.data());
+
+    // The element array binding is VAO state, so upload through another target
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * sizeof(unsigned int),
+                    indices.size() * sizeof(unsigned int), indices.data());
+
+    m_originStaging.assign(pageCount, glm::vec4(origin, 0.0f));
+    glBindBuffer(GL_TEXTURE_BUFFER, m_originBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, firstPage * sizeof(glm::vec4),
+                    m_originStaging.size() * sizeof(glm::vec4), m_originStaging.data());
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    return allocation;
+}
+
+void ChunkGeometryArena::release(Allocation& allocation) {
+    if (allocation.indexCount > 0) {
+        m_pages.release(allocation.firstPage, allocation.pageCount);
+        m_indices.release(allocation.firstIndex, allocation.indexCount);
+    }
+    allocation = Allocation{};
+}
+
+void ChunkGeometryArena::queueDraw(const Allocation& allocation) {
+    if (allocation.indexCount == 0) return;
+    m_drawCounts.push_back(static_cast<GLsizei>(allocation.indexCount));
+    m_drawOffsets.push_back(reinterpret_cast<const void*>(
+        static_cast<std::size_t>(allocation.firstIndex) * sizeof(unsigned int)));
+    m_drawBaseVertices.push_back(static_cast<GLint>(allocation.firstPage * PAGE_VERTICES));
+}
+
+void ChunkGeometryArena::drawQueued(int originTextureUnit) {
+    if (!m_drawCounts.empty()) {
+        glActiveTexture(GL_TEXTURE0 + originTextureUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, m_originTexture);
+        glActiveTexture(GL_TEXTURE0);
+
+        glBindVertexArray(m_vao);
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_drawCounts.data(), GL_UNSIGNED_INT,
+                                      m_drawOffsets.data(),
+                                      static_cast<GLsizei>(m_drawCounts.size()),
+                                      m_drawBaseVertices.data());
+        glBindVertexArray(0);
+    }
+    m_drawCounts.clear();
+    m_drawOffsets.clear();
+    m_drawBaseVertices.clear();
+}
+
+std::size_t ChunkGeometryArena::capacityBytes() const {
+    return m_pages.capacity() * (PAGE_BYTES + sizeof(glm::vec4)) +
+           std::size_t(m_indices.capacity()) * sizeof(unsigned int);
+}
+
+std::size_t ChunkGeometryArena::usedBytes() const {
+    return m_pages.used() * (PAGE_BYTES + sizeof(glm::vec4)) +
+           std::size_t(m_indices.used()) * sizeof(unsigned int);
+}
+
+void ChunkGeometryArena::reserve(u32 pageCapacity, u32 indexCapacity) {
+    if (m_vao == 0) {
+        glGenVertexArrays(1, &m_vao);
+        glGenTextures(1, &m_originTexture);
+        pageCapacity = std::max(pageCapacity, INITIAL_PAGES);
+        indexCapacity = std::max(indexCapacity, INITIAL_INDICES);
+    }
+    pageCapacity = std::max(pageCapacity, m_pages.capacity());
+    indexCapacity = std::max(indexCapacity, m_indices.capacity());
+
+    m_vertexBuffer = growBuffer(m_vertexBuffer, m_pages.capacity() * PAGE_BYTES,
+                                pageCapacity * PAGE_BYTES);
+    m_indexBuffer = growBuffer(m_indexBuffer, m_indices.capacity() * sizeof(unsigned int),
+                               indexCapacity * sizeof(unsigned int));
+    m_originBuffer = growBuffer(m_originBuffer, m_pages.capacity() * sizeof(glm::vec4),
+                                pageCapacity * sizeof(glm::vec4));
+    m_pages.grow(pageCapacity);
+    m_indices.grow(indexCapacity);
+
+    // Point the VAO and the origin texture at the new buffers
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    
+    // Packed vertex attribute, read as two integers and decoded in the vertex shader
+    glVertexAttribIPointer(3, 2, GL_UNSIGNED_INT, sizeof(PackedVoxelVertex), (void*)0);
+    glEnableVertexAttribArray(3);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, m_originTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_originBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+GLuint ChunkGeometryArena::growBuffer(GLuint buffer, std::size_t oldBytes, std::size_t newBytes) {
+    GLuint grown;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, newBytes, nullptr, GL_DYNAMIC_DRAW);
+    if (buffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return grown;
+}
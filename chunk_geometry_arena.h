@@ -0,0 +1,108 @@
+#pragma once
+
+#include "world/packed_vertex.h"
+#include "world/range_allocator.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * @brief One vertex buffer and one index buffer shared by the voxel geometry of every chunk
+ * Vertices are allocated in pages of PAGE_VERTICES, and a buffer texture holds the world
+ * space origin of each page. The vertex shader looks the origin up with gl_VertexID, so
+ * chunks need no model matrix and any set of them is drawn with one multi-draw call.
+ * Buffers are created on first use and grow as needed, so a GL context must be current.
+ */
+class ChunkGeometryArena {
+public:
+    // Must match ARENA_PAGE_VERTICES in shaders/vertex.vs
+    static constexpr u32 PAGE_VERTICES = 256;
+
+    /**
+     * @brief Where the geometry of one chunk lives in the arena
+     */
+    struct Allocation {
+        u32 firstPage = 0;
+        u32 pageCount = 0;
+        u32 firstIndex = 0;
+        u32 indexCount = 0;
+    };
+
+    ChunkGeometryArena();
+    ~ChunkGeometryArena();
+
+    ChunkGeometryArena(const ChunkGeometryArena&) = delete;
+    ChunkGeometryArena& operator=(const ChunkGeometryArena&) = delete;
+
+    /**
+     * @brief Copy chunk geometry into the arena
+     * @param vertices Vertices relative to the chunk origin
+     * @param indices Indices into vertices
+     * @param origin World space position of the chunk
+     * @return The allocation, empty if there are no indices
+     */
+    Allocation allocate(const std::vector<PackedVoxelVertex>& vertices,
+                        const std::vector<unsigned int>& indices, const glm::vec3& origin);
+
+    /**
+     * @brief Free the space of an allocation and reset it to empty
+     * @param allocation Allocation returned by allocate
+     */
+    void release(Allocation& allocation);
+
+    /**
+     * @brief Queue an allocation to be drawn by drawQueued
+     * @param allocation The geometry to draw, ignored if empty
+     */
+    void queueDraw(const Allocation& allocation);
+
+    /**
+     * @brief Draw every queued allocation with one glMultiDrawElementsBaseVertex, then clear the queue
+     * @param originTextureUnit Texture unit to bind the page origins to, the shader's
+     *        chunkOrigins sampler must use the same unit
+     */
+    void drawQueued(int originTextureUnit);
+
+    /**
+     * @brief Bytes of GPU memory held by the arena
+     */
+    std::size_t capacityBytes() const;
+
+    /**
+     * @brief Bytes of GPU memory used by allocations
+     */
+    std::size_t usedBytes() const;
+
+private:
+    /**
+     * @brief Create the buffers, or move their contents into larger ones
+     * @param pageCapacity Minimum number of vertex pages
+     * @param indexCapacity Minimum number of indices
+     */
+    void reserve(u32 pageCapacity, u32 indexCapacity);
+
+    /**
+     * @brief Replace a buffer with a larger one, keeping its contents
+     * @return The new buffer
+     */
+    GLuint growBuffer(GLuint buffer, std::size_t oldBytes, std::size_t newBytes);
+
+    GLuint m_vao;
+    GLuint m_vertexBuffer;
+    GLuint m_indexBuffer;
+    
+    // One vec4 world space origin per vertex page, read through m_originTexture
+    GLuint m_originBuffer;
+    GLuint m_originTexture;
+    
+    RangeAllocator m_pages;
+    RangeAllocator m_indices;
+    
+    // Page origins of the allocation being uploaded, kept so uploads don't allocate
+    std::vector<glm::vec4> m_originStaging;
+    
+    // Arguments of the next glMultiDrawElementsBaseVertex
+    std::vector<GLsizei> m_drawCounts;
+    std::vector<const void*> m_drawOffsets;
+    std::vector<GLint> m_drawBaseVertices;
+};
@@ -0,0 +1,82 @@
+#include "chunk_mesh_uploader.h"
+
+std::size_t ChunkGpuMesh::gpuBytes() const {
+    // Counted like ChunkGeometryArena::usedBytes, each page has an origin texel too
+    return geometry.pageCount * (ChunkGeometryArena::PAGE_VERTICES * sizeof(PackedVoxelVertex) +
+                                 sizeof(glm::vec4)) +
+           geometry.indexCount * sizeof(unsigned int) + modelBytes;
+}
+
+ChunkMeshUploader::ChunkMeshUploader() : m_modelBytes(0) {}
+
+void ChunkMeshUploader::upload(ChunkGpuMesh& mesh, const ChunkMeshData& data, const glm::vec3& origin) {
+    // Replace the chunk's voxel geometry in the arena
+    m_geometryArena.release(mesh.geometry);
+    mesh.geometry = m_geometryArena.allocate(data.vertices, data.indices, origin);
+
+    mesh.modelIndexCount = static_cast<int>(data.modelIndices.size());
+    m_modelBytes -= mesh.modelBytes;
+    mesh.modelBytes = mesh.modelIndexCount == 0 ? 0 :
+        data.modelVertices.size() * sizeof(float) + data.modelIndices.size() * sizeof(unsigned int);
+    m_modelBytes += mesh.modelBytes;
+
+    // Model geometry keeps the float layout, and only gets buffers when a chunk has some
+    if (mesh.modelIndexCount == 0) return;
+
+    if (mesh.modelVAO == 0) {
+        glGenVertexArrays(1, &mesh.modelVAO);
+        glGenBuffers(1, &mesh.modelVBO);
+        glGenBuffers(1, &mesh.modelEBO);
+    }
+
+    glBindVertexArray(mesh.modelVAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.modelVBO);
+    glBufferData(GL_ARRAY_BUFFER, data.modelVertices.size() * sizeof(float), data.modelVertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.modelEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.modelIndices.size() * sizeof(unsigned int), data.modelIndices.data(), GL_STATIC_DRAW);
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Normal attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // Texture coordinate attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+}
+
+void ChunkMeshUploader::release(ChunkGpuMesh& mesh) {
+    m_geometryArena.release(mesh.geometry);
+    if (mesh.modelVAO != 0) {
+        glDeleteVertexArrays(1, &mesh.modelVAO);
+        glDeleteBuffers(1, &mesh.modelVBO);
+        glDeleteBuffers(1, &mesh.modelEBO);
+    }
+    m_modelBytes -= mesh.modelBytes;
+    mesh = ChunkGpuMesh();
+}
+
+void ChunkMeshUploader::queueDraw(const ChunkGpuMesh& mesh) {
+    m_geometryArena.queueDraw(mesh.geometry);
+}
+
+void ChunkMeshUploader::drawQueued(int originTextureUnit) {
+    m_geometryArena.drawQueued(originTextureUnit);
+}
+
+void ChunkMeshUploader::drawModels(const ChunkGpuMesh& mesh) const {
+    if (mesh.modelIndexCount == 0) return;
+    glBindVertexArray(mesh.modelVAO);
+    glDrawElements(GL_TRIANGLES, mesh.modelIndexCount, GL_UNSIGNED_INT, 0);
+}
+
+std::size_t ChunkMeshUploader::usedBytes() const {
+    return m_geometryArena.usedBytes() + m_modelBytes;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "chunk_geometry_arena.h"
+#include "world/chunk_mesher.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/**
+ * @brief The GPU side of one chunk's geometry, created and freed by ChunkMeshUploader
+ */
+struct ChunkGpuMesh {
+    // Voxel and cross geometry, in the uploader's arena
+    ChunkGeometryArena::Allocation geometry;
+    // VoxelMeshStyle::Model geometry, only created for chunks that contain some
+    GLuint modelVAO = 0, modelVBO = 0, modelEBO = 0;
+    int modelIndexCount = 0;
+    std::size_t modelBytes = 0;
+
+    bool empty() const { return geometry.indexCount == 0 && modelIndexCount == 0; }
+
+    /**
+     * @brief Bytes of GPU memory the mesh holds, whole arena pages included
+     */
+    std::size_t gpuBytes() const;
+};
+
+/**
+ * @brief Copies ChunkMeshData built on the CPU into GPU buffers, and draws them
+ * The only part of chunk meshing that needs a GL context, so it must be used on the
+ * render thread while the meshes themselves are built anywhere
+ */
+class ChunkMeshUploader {
+public:
+    ChunkMeshUploader();
+
+    ChunkMeshUploader(const ChunkMeshUploader&) = delete;
+    ChunkMeshUploader& operator=(const ChunkMeshUploader&) = delete;
+
+    /**
+     * @brief Replace the geometry of a chunk with new data
+     * @param mesh The chunk's GPU mesh, empty for a chunk that was never uploaded
+     * @param data Geometry to upload, relative to the chunk origin
+     * @param origin World space position of the chunk
+     */
+    void upload(ChunkGpuMesh& mesh, const ChunkMeshData& data, const glm::vec3& origin);
+
+    /**
+     * @brief Free the GPU memory of a mesh and reset it to empty
+     * @param mesh Mesh returned by upload
+     */
+    void release(ChunkGpuMesh& mesh);
+
+    /**
+     * @brief Queue the voxel geometry of a mesh to be drawn by drawQueued
+     */
+    void queueDraw(const ChunkGpuMesh& mesh);
+
+    /**
+     * @brief Draw the queued voxel geometry in one call, see ChunkGeometryArena::drawQueued
+     * @param originTextureUnit Texture unit for the arena's page origins
+     */
+    void drawQueued(int originTextureUnit);
+
+    /**
+     * @brief Draw the model geometry of a mesh, the caller sets its model matrix
+     */
+    void drawModels(const ChunkGpuMesh& mesh) const;
+
+    /**
+     * @brief Bytes of GPU memory used by every uploaded mesh
+     */
+    std::size_t usedBytes() const;
+
+private:
+    ChunkGeometryArena m_geometryArena;
+    std::size_t m_modelBytes;
+};
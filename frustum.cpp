@@ -0,0 +1,37 @@
+#include "frustum.h"
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    // glm is column major, so row i is m[0][i], m[1][i], m[2][i], m[3][i]
+    auto row = [&viewProjection](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i],
+                         viewProjection[3][i]);
+    };
+    glm::vec4 x = row(0);
+    glm::vec4 y = row(1);
+    glm::vec4 z = row(2);
+    glm::vec4 w = row(3);
+
+    m_planes = {w + x, w - x, w + y, w - y, w + z, w - z};
+}
+
+bool Frustum::isBoxVisible(const AABB& box) const {
+    for (const glm::vec4& plane : m_planes) {
+        // The corner of the box furthest along the plane normal
+        glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x,
+                         plane.y >= 0.0f ? box.max.y : box.min.y,
+                         plane.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Frustum::cullBoxes(const AABB* boxes, std::size_t count, std::vector<u32>& visible) const {
+    visible.clear();
+    for (std::size_t i = 0; i < count; i++) {
+        if (isBoxVisible(boxes[i])) {
+            visible.push_back(static_cast<u32>(i));
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "types.h"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Axis aligned bounding box in world space
+ */
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+/**
+ * @brief The 6 clip planes of a view-projection matrix
+ */
+class Frustum {
+public:
+    /**
+     * @brief Extract the planes from a view-projection matrix (Gribb/Hartmann)
+     * @param viewProjection projection * view
+     */
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    /**
+     * @brief Check if any part of a box may be inside the frustum
+     * Boxes near a corner of the frustum can be reported visible when they are not
+     * @param box The box to test
+     * @return true unless the box is fully outside one of the planes
+     */
+    bool isBoxVisible(const AABB& box) const;
+
+    /**
+     * @brief Test many boxes at once
+     * @param boxes Boxes to test, contiguous
+     * @param count Number of boxes
+     * @param visible Indices of the boxes that may be visible, replaced
+     */
+    void cullBoxes(const AABB* boxes, std::size_t count, std::vector<u32>& visible) const;
+
+private:
+    // xyz = plane normal pointing into the frustum, w = distance
+    // Order: left, right, bottom, top, near, far
+    std::array<glm::vec4, 6> m_planes;
+};
@@ -82,6 +82,83 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     // delete the shaders as they're linked into our program now and no longer necessary
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    cacheUniforms();
+}
+
+void Shader::cacheUniforms()
+{
+    int count = 0;
+    int maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::string name(maxNameLength > 0 ? maxNameLength : 1, '\0');
+    for (int i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, i, static_cast<GLsizei>(name.size()), &length, &size, &type, &name[0]);
+        std::string uniformName = name.substr(0, length);
+        m_uniforms[uniformName] = {glGetUniformLocation(ID, uniformName.c_str()), type};
+
+        // arrays of plain types are listed once as "name[0]", add every element and "name"
+        std::size_t bracket = uniformName.rfind("[0]");
+        if (size > 1 && bracket != std::string::npos && bracket + 3 == uniformName.size())
+        {
+            std::string arrayName = uniformName.substr(0, bracket);
+            m_uniforms[arrayName] = m_uniforms[uniformName];
+            for (int element = 1; element < size; element++)
+            {
+                std::string elementName = arrayName + "[" + std::to_string(element) + "]";
+                m_uniforms[elementName] = {glGetUniformLocation(ID, elementName.c_str()), type};
+            }
+        }
+    }
+}
+
+int Shader::uniformLocation(const std::string &name) const
+{
+    auto it = m_uniforms.find(name);
+    if (it != m_uniforms.end())
+    {
+        return it->second.location;
+    }
+    std::cout << "WARNING::SHADER::UNIFORM_NOT_FOUND " << name
+              << " (not declared, or unused and optimised out)" << std::endl;
+    m_uniforms[name] = {-1, 0};
+    return -1;
+}
+
+int Shader::findUniform(const std::string &name, UniformKind kind) const
+{
+    int location = uniformLocation(name);
+    if (location == -1)
+    {
+        return -1;
+    }
+
+    GLenum type = m_uniforms.at(name).type;
+    bool matches = false;
+    switch (kind)
+    {
+        case UniformKind::Bool:  matches = type == GL_BOOL; break;
+        case UniformKind::Float: matches = type == GL_FLOAT; break;
+        case UniformKind::Vec3:  matches = type == GL_FLOAT_VEC3; break;
+        case UniformKind::Mat4:  matches = type == GL_FLOAT_MAT4; break;
+        case UniformKind::Int:
+            matches = type == GL_INT || type == GL_SAMPLER_2D || type == GL_SAMPLER_3D ||
+                      type == GL_SAMPLER_CUBE || type == GL_SAMPLER_2D_ARRAY ||
+                      type == GL_SAMPLER_BUFFER || type == GL_INT_SAMPLER_BUFFER ||
+                      type == GL_UNSIGNED_INT_SAMPLER_BUFFER;
+            break;
+    }
+    if (!matches)
+    {
+        std::cout << "WARNING::SHADER::UNIFORM_TYPE_MISMATCH " << name << std::endl;
+    }
+    return location;
 }
 
 void Shader::use(){
@@ -89,22 +166,42 @@ void Shader::use(){
 }
 
 
+void Shader::set(ShaderUniform<bool> uniform, bool value) const
+{
+    glUniform1i(uniform.location, (int)value);
+}
+void Shader::set(ShaderUniform<int> uniform, int value) const
+{
+    glUniform1i(uniform.location, value);
+}
+void Shader::set(ShaderUniform<float> uniform, float value) const
+{
+    glUniform1f(uniform.location, value);
+}
+void Shader::set(ShaderUniform<glm::vec3> uniform, const glm::vec3 &value) const
+{
+    glUniform3f(uniform.location, value.x, value.y, value.z);
+}
+void Shader::set(ShaderUniform<glm::mat4> uniform, const glm::mat4 &value) const
+{
+    glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
 void Shader::setBool(const std::string &name, bool value) const
 {         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    glUniform1i(uniformLocation(name), (int)value); 
 }
 void Shader::setInt(const std::string &name, int value) const
 { 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    glUniform1i(uniformLocation(name), value); 
 }
 void Shader::setVec3(const std::string &name, glm::vec3 value) const{
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z);
+    glUniform3f(uniformLocation(name), value.x, value.y, value.z);
 }
 void Shader::setFloat(const std::string &name, float value) const
 { 
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    glUniform1f(uniformLocation(name), value); 
 }
 void Shader::setMat4(const std::string &name, const glm::mat4 value) const{
-    int Loc = glGetUniformLocation(ID, name.c_str());
-    glUniformMatrix4fv(Loc, 1, GL_FALSE, glm::value_ptr(value));
+    glUniformMatrix4fv(uniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 }
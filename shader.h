@@ -5,8 +5,32 @@
 #include <fstream>
 #include <sstream>
 #include<iostream>
+#include <unordered_map>
 #include <glm/glm/glm.hpp>
 
+// The kinds of value a ShaderUniform can hold
+enum class UniformKind {
+    Bool,
+    Int,    // Also sampler uniforms, set to a texture unit
+    Float,
+    Vec3,
+    Mat4
+};
+
+template <typename T> struct UniformKindOf;
+template <> struct UniformKindOf<bool> { static constexpr UniformKind value = UniformKind::Bool; };
+template <> struct UniformKindOf<int> { static constexpr UniformKind value = UniformKind::Int; };
+template <> struct UniformKindOf<float> { static constexpr UniformKind value = UniformKind::Float; };
+template <> struct UniformKindOf<glm::vec3> { static constexpr UniformKind value = UniformKind::Vec3; };
+template <> struct UniformKindOf<glm::mat4> { static constexpr UniformKind value = UniformKind::Mat4; };
+
+// A uniform location resolved once with Shader::getUniform, setting it needs no lookup
+// Location -1 (a missing uniform) is ignored by GL, like with the string setters
+template <typename T>
+struct ShaderUniform {
+    int location = -1;
+};
+
 class Shader{
     public:
         // the program ID
@@ -16,12 +40,43 @@ class Shader{
         Shader(const char* vertexPath, const char* fragmentPath);
         // use/activate the shader
         void use();
-        // utility uniforms functions
+        
+        // resolve a uniform for the typed setters below, reporting once if it is missing
+        // or declared with a different type
+        template <typename T>
+        ShaderUniform<T> getUniform(const std::string &name) const {
+            return {findUniform(name, UniformKindOf<T>::value)};
+        }
+        
+        // typed setters for hot loops, no string lookups
+        void set(ShaderUniform<bool> uniform, bool value) const;
+        void set(ShaderUniform<int> uniform, int value) const;
+        void set(ShaderUniform<float> uniform, float value) const;
+        void set(ShaderUniform<glm::vec3> uniform, const glm::vec3 &value) const;
+        void set(ShaderUniform<glm::mat4> uniform, const glm::mat4 &value) const;
+        
+        // utility uniforms functions, locations come from a cache filled after linking
         void setBool(const std::string &name, bool value) const;
         void setInt(const std::string &name, int value) const;
         void setVec3(const std::string &name, glm::vec3 value) const;
         void setFloat(const std::string &name, float value) const;
         void setMat4(const std::string &name, const glm::mat4 value) const;
+
+    private:
+        struct UniformInfo {
+            int location;
+            unsigned int type;  // GL type from glGetActiveUniform, 0 for missing uniforms
+        };
+        
+        // fill m_uniforms with every active uniform of the linked program
+        void cacheUniforms();
+        
+        // location of a uniform, reporting the first lookup of a missing one
+        int uniformLocation(const std::string &name) const;
+        int findUniform(const std::string &name, UniformKind kind) const;
+        
+        // missing uniforms are added with location -1 the first time they are looked up
+        mutable std::unordered_map<std::string, UniformInfo> m_uniforms;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,10 +4,15 @@ out vec4 FragColor;
 in vec3 Normal;
 in vec2 TexCoords;
 in vec3 FragPos;
+flat in uint TextureLayer;
 
 // texture sampler
 uniform sampler2D texture1;
 
+// Every block texture, sampled by packed voxel geometry (see block_texture_array.h)
+uniform sampler2DArray blockTextures;
+uniform bool packedVertex;
+
 // lighting
 uniform vec3 lightColor;
 uniform vec3 viewPos;
@@ -89,6 +94,11 @@ void main()
 
     // FragColor = vec4(result, 1.0);
 
+    if (packedVertex)
+    {
+        FragColor = texture(blockTextures, vec3(TexCoords, float(TextureLayer)));
+        return;
+    }
     FragColor = vec4(texture(texture1, TexCoords));
 }
 
@@ -2,25 +2,59 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+// Voxel geometry in the PackedVoxelVertex format (see world/packed_vertex.h)
+layout (location = 3) in uvec2 aPacked;
 
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 FragPos;
+// Layer of blockTextures for packed voxel geometry
+flat out uint TextureLayer;
 
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// true when drawing packed voxel geometry instead of the float layout
+uniform bool packedVertex;
+
+// World space origin of each page of the chunk geometry arena (see chunk_geometry_arena.h)
+// Packed geometry is positioned with these instead of the model matrix
+uniform samplerBuffer chunkOrigins;
+const int ARENA_PAGE_VERTICES = 256;
+
+// Indexed by face direction: left, right, bottom, top, back, front
+const vec3 FACE_NORMALS[6] = vec3[6](
+	vec3(-1.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0),
+	vec3(0.0, -1.0, 0.0), vec3(0.0, 1.0, 0.0),
+	vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0)
+);
+
 
 void main()
 {
+	if (packedVertex)
+	{
+		uvec3 corner = uvec3(aPacked.x, aPacked.x >> 6u, aPacked.x >> 12u) & 63u;
+		vec3 origin = texelFetch(chunkOrigins, gl_VertexID / ARENA_PAGE_VERTICES).xyz;
+		vec3 position = origin + vec3(corner) - 0.5;
+
+		gl_Position = projection * view * vec4(position, 1.0);
+		TexCoords = vec2(uvec2(aPacked.y, aPacked.y >> 6u) & 63u);
+		TextureLayer = (aPacked.y >> 12u) & 4095u;
+		FragPos = position;
+		Normal = FACE_NORMALS[(aPacked.x >> 18u) & 7u];
+		return;
+	}
+
 	// note that we read the multiplication from right to left
 	gl_Position = projection * view * model * vec4(aPos, 1.0);
-	TexCoords = vec2(aTexCoord.x, aTexCoord.y);
+	TexCoords = aTexCoord;
+	TextureLayer = 0u;
 	FragPos = vec3(model * vec4(aPos, 1.0));
 	
 	// Transform normals to world space using the normal matrix
 	// The normal matrix is the transpose of the inverse of the upper-left 3x3 of the model matrix
 	Normal = mat3(transpose(inverse(model))) * aNormal;
-}
\ No newline at end of file
+}
@@ -2,12 +2,18 @@
 #include "world/world_constants.h"
 #include "world/terrain_generation.h"
 #include "world/coordinate.h"
+#include "model.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/noise.hpp>
 #include <glad/glad.h>
 
-VoxelWorld::VoxelWorld() : m_renderDistance(4), m_lastCameraChunk({0, 0, 0}), m_currentChunk(nullptr), m_worldSeed(12345), m_worldSize(64) {
+VoxelWorld::VoxelWorld() : m_renderDistance(4), m_worldSeed(12345), m_worldSize(64), m_meshingMode(VoxelMeshingMode::Greedy), m_faceCullingMode(FaceCullingMode::Bitmask), m_chunkBoundsDirty(false), m_meshUploadBudget(4 * 1024 * 1024), m_snapshotPool(64), m_meshResultPool(64), m_peakMeshVertices(0), m_peakMeshIndices(0), m_updateCount(0), m_regionStorage("saves/world_" + std::to_string(m_worldSeed)), m_chunkIO(m_regionStorage), m_loadedColumns(0), m_savedColumns(0), m_chunkMemoryBudget(256 * 1024 * 1024), m_meshMemoryBudget(256 * 1024 * 1024), m_unloadMargin(2), m_evictedColumns(0), m_evictedChunks(0), m_nextMeshVersion(0), m_skippedMeshes(0), m_lastCameraChunk({0, 0, 0}), m_remeshTimeBudget(2.0f) {
+    // Voxel types look their face textures up in the texture array
+    m_blockTextures.load("models");
     // Initialize basic voxel types
     initializeVoxelTypes();
     // Load block models
@@ -15,11 +21,11 @@ VoxelWorld::VoxelWorld() : m_renderDistance(4), m_lastCameraChunk({0, 0, 0}), m_
 }
 
 VoxelWorld::~VoxelWorld() {
+    saveWorld();
+    
     // Clean up OpenGL resources
     for (auto& [pos, mesh] : m_chunkMeshes) {
-        glDeleteVertexArrays(1, &mesh.VAO);
-        glDeleteBuffers(1, &mesh.VBO);
-        glDeleteBuffers(1, &mesh.EBO);
+        m_meshUploader.release(mesh.gpu);
     }
 }
 
@@ -40,19 +46,24 @@ void VoxelWorld::initializeVoxelTypes() {
     // Example: Add a flower voxel that uses cross mesh style
     VoxelData flower = {6, "flower", "flower", "flower", "flower", "", 0, 0, 0, VoxelMeshStyle::Cross, VoxelType::Flora, false};
     
-    m_voxelDataManager.addVoxelData(air);
-    m_voxelDataManager.addVoxelData(stone);
-    m_voxelDataManager.addVoxelData(grass);
-    m_voxelDataManager.addVoxelData(dirt);
-    m_voxelDataManager.addVoxelData(sand);
-    m_voxelDataManager.addVoxelData(water);
-    m_voxelDataManager.addVoxelData(flower);
+    for (VoxelData* voxel : {&air, &stone, &grass, &dirt, &sand, &water, &flower}) {
+        voxel->topTextureLayer = m_blockTextures.layer(voxel->topTexture);
+        voxel->sideTextureLayer = m_blockTextures.layer(voxel->sideTexture);
+        voxel->bottomTextureLayer = m_blockTextures.layer(voxel->bottomTexture);
+        m_voxelDataManager.addVoxelData(*voxel);
+    }
     
     // Initialize common voxel types lookup
     m_voxelDataManager.initCommonVoxelTypes();
 }
 
 void VoxelWorld::update(const glm::vec3& cameraPosition) {
+    m_updateCount++;
+    
+    // Pick up columns and meshes finished by the workers since the last frame
+    mergeGeneratedColumns();
+    uploadCompletedMeshes();
+    
     ChunkPosition currentChunk = worldToChunkPosition(cameraPosition);
     
     // Only update if camera moved to a different chunk
@@ -61,8 +72,10 @@ void VoxelWorld::update(const glm::vec3& cameraPosition) {
         currentChunk.z != m_lastCameraChunk.z) {
         
         m_lastCameraChunk = currentChunk;
+        m_chunkIO.setFocus(currentChunk);
         
         // Generate chunks in render distance
+        std::vector<ChunkPosition> missingColumns;
         for (int x = -m_renderDistance; x <= m_renderDistance; x++) {
             for (int z = -m_renderDistance; z <= m_renderDistance; z++) {
                 ChunkPosition columnPos = {
@@ -72,36 +85,110 @@ void VoxelWorld::update(const glm::vec3& cameraPosition) {
                 };
                 
                 // Check if this chunk column needs to be generated
-                if (!m_chunkManager.hasChunk(columnPos)) {
-                    generateChunkColumn(columnPos.x, columnPos.z);
+                // Neighbouring columns add empty chunks here, so hasChunk can't tell
+                auto column = m_requestedColumns.find(columnPos);
+                if (column == m_requestedColumns.end()) {
+                    missingColumns.push_back(columnPos);
+                }
+                else {
+                    column->second = m_updateCount;
                 }
             }
         }
+        
+        // Nearest first, columns are added in request order
+        std::stable_sort(missingColumns.begin(), missingColumns.end(),
+                         [&currentChunk](const ChunkPosition& a, const ChunkPosition& b) {
+            auto distance = [&currentChunk](const ChunkPosition& pos) {
+                int dx = pos.x - currentChunk.x;
+                int dz = pos.z - currentChunk.z;
+                return dx * dx + dz * dz;
+            };
+            return distance(a) < distance(b);
+        });
+        for (const ChunkPosition& columnPos : missingColumns) {
+            requestChunkColumn(columnPos.x, columnPos.z);
+        }
+        
+        evictColumns();
+        
+        // Read ahead the stored columns the camera reaches next
+        const int ringDistance = m_renderDistance + 1;
+        std::vector<ChunkPosition> ring;
+        for (int x = -ringDistance; x <= ringDistance; x++) {
+            for (int z = -ringDistance; z <= ringDistance; z++) {
+                ChunkPosition columnPos = {currentChunk.x + x, 0, currentChunk.z + z};
+                if (std::max(std::abs(x), std::abs(z)) == ringDistance &&
+                    m_requestedColumns.count(columnPos) == 0) {
+                    ring.push_back(columnPos);
+                }
+            }
+        }
+        m_chunkIO.requestPrefetch(std::move(ring));
     }
+    
+    // Edits made since the last frame
+    remeshDirtyChunks();
 }
 
 void VoxelWorld::render(Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
     shader.use();
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
     
-    // Render all chunk meshes
-    for (auto& [pos, mesh] : m_chunkMeshes) {
-        if (mesh.indexCount > 0) {
-            // Calculate world position of chunk
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(
-                pos.x * CHUNK_SIZE,
-                pos.y * CHUNK_SIZE,
-                pos.z * CHUNK_SIZE
-            ));
-            shader.setMat4("model", model);
-            
-            glBindVertexArray(mesh.VAO);
-            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
-        }
+    // Resolve the uniforms once per shader program
+    if (m_uniforms.program != shader.ID) {
+        m_uniforms.program = shader.ID;
+        m_uniforms.view = shader.getUniform<glm::mat4>("view");
+        m_uniforms.projection = shader.getUniform<glm::mat4>("projection");
+        m_uniforms.model = shader.getUniform<glm::mat4>("model");
+        m_uniforms.packedVertex = shader.getUniform<bool>("packedVertex");
+        m_uniforms.chunkOrigins = shader.getUniform<int>("chunkOrigins");
+        m_uniforms.blockTextures = shader.getUniform<int>("blockTextures");
+    }
+    shader.set(m_uniforms.view, view);
+    shader.set(m_uniforms.projection, projection);
+    
+    // Only draw chunks that intersect the view frustum
+    if (m_chunkBoundsDirty) {
+        rebuildChunkBounds();
+    }
+    Frustum frustum(projection * view);
+    frustum.cullBoxes(m_chunkBounds.data(), m_chunkBounds.size(), m_visibleChunks);
+    
+    m_cullingStats.tested = static_cast<u32>(m_chunkBounds.size());
+    m_cullingStats.drawn = static_cast<u32>(m_visibleChunks.size());
+    m_cullingStats.culled = m_cullingStats.tested - m_cullingStats.drawn;
+    
+    // Voxel geometry of every visible chunk in one draw, positioned by the arena's page origins
+    for (u32 index : m_visibleChunks) {
+        m_meshUploader.queueDraw(m_chunkBoundsMeshes[index]->gpu);
+    }
+    shader.set(m_uniforms.packedVertex, true);
+    shader.set(m_uniforms.chunkOrigins, CHUNK_ORIGIN_TEXTURE_UNIT);
+    shader.set(m_uniforms.blockTextures, BLOCK_TEXTURE_UNIT);
+    m_blockTextures.bind(BLOCK_TEXTURE_UNIT);
+    m_meshUploader.drawQueued(CHUNK_ORIGIN_TEXTURE_UNIT);
+    
+    // Model geometry keeps a buffer per chunk and a model matrix
+    shader.set(m_uniforms.packedVertex, false);
+    for (u32 index : m_visibleChunks) {
+        const ChunkMesh& mesh = *m_chunkBoundsMeshes[index];
+        if (mesh.gpu.modelIndexCount == 0) continue;
+        
+        const ChunkPosition& pos = mesh.position;
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(
+            pos.x * CHUNK_SIZE,
+            pos.y * CHUNK_SIZE,
+            pos.z * CHUNK_SIZE
+        ));
+        shader.set(m_uniforms.model, model);
+        
+        m_meshUploader.drawModels(mesh.gpu);
     }
     glBindVertexArray(0);
+    
+    // Other geometry drawn with this shader uses the float vertex layout
+    shader.set(m_uniforms.packedVertex, false);
 }
 
 void VoxelWorld::generateChunk(const ChunkPosition& chunkPos) {
@@ -112,6 +199,20 @@ void VoxelWorld::generateChunk(const ChunkPosition& chunkPos) {
 }
 
 void VoxelWorld::generateChunkColumn(int chunkX, int chunkZ) {
+    m_requestedColumns[{chunkX, 0, chunkZ}] = m_updateCount;
+    
+    // The column may still be queued to be saved
+    m_chunkIO.flush();
+    LoadedColumn stored;
+    if (m_regionStorage.loadColumn(chunkX, chunkZ, stored)) {
+        m_loadedColumns++;
+        for (const ChunkPosition& pos : addLoadedColumn(m_chunkManager, stored)) {
+            requestChunkMesh(pos);
+        }
+        return;
+    }
+    m_unsavedColumns.insert({chunkX, 0, chunkZ});
+    
     // Use the advanced terrain generation system
     std::vector<ChunkPosition> generatedChunks = ::generateTerrain(
         m_chunkManager, 
@@ -122,9 +223,82 @@ void VoxelWorld::generateChunkColumn(int chunkX, int chunkZ) {
         m_worldSize
     );
     
-    // Generate meshes for all the chunks that were created
+    // Mesh all the chunks that were created on the workers
     for (const ChunkPosition& pos : generatedChunks) {
-        generateChunkMesh(pos);
+        requestChunkMesh(pos);
+    }
+}
+
+void VoxelWorld::requestChunkColumn(int chunkX, int chunkZ) {
+    m_requestedColumns[{chunkX, 0, chunkZ}] = m_updateCount;
+    
+    auto job = std::make_shared<ColumnGenerationJob>();
+    job->chunkX = chunkX;
+    job->chunkZ = chunkZ;
+    m_columnJobs.push_back(job);
+    m_pendingColumns[{chunkX, 0, chunkZ}] = job;
+    
+    // A visited column is decoded from its region file, the rest are generated once
+    // the I/O thread found nothing stored
+    job->ioRequest = m_chunkIO.requestLoad({chunkX, 0, chunkZ});
+}
+
+void VoxelWorld::receiveLoadedColumns() {
+    ChunkIO::LoadResult result;
+    while (m_chunkIO.popCompleted(result)) {
+        // Unloaded or requested again since the load was queued
+        auto pending = m_pendingColumns.find(result.column);
+        if (pending == m_pendingColumns.end() || pending->second->ioRequest != result.request) {
+            continue;
+        }
+        std::shared_ptr<ColumnGenerationJob> job = pending->second;
+        job->ioRequest = 0;
+        
+        if (result.found) {
+            job->loaded = true;
+            job->stored = std::move(result.data);
+            job->done.store(true, std::memory_order_release);
+            continue;
+        }
+        
+        int chunkX = job->chunkX;
+        int chunkZ = job->chunkZ;
+        int seed = m_worldSeed;
+        int worldSize = m_worldSize;
+        m_workers.submit([this, job, chunkX, chunkZ, seed, worldSize] {
+            job->column = ::generateColumn(chunkX, chunkZ, m_voxelDataManager, seed, worldSize);
+            job->done.store(true, std::memory_order_release);
+        });
+    }
+}
+
+void VoxelWorld::mergeGeneratedColumns() {
+    receiveLoadedColumns();
+    
+    // Stop at the first unfinished column so they are always merged in request order
+    while (!m_columnJobs.empty() && m_columnJobs.front()->done.load(std::memory_order_acquire)) {
+        std::shared_ptr<ColumnGenerationJob> job = std::move(m_columnJobs.front());
+        m_columnJobs.pop_front();
+        
+        // Unloaded again while it was being generated, or requested again after that
+        ChunkPosition column = {job->chunkX, 0, job->chunkZ};
+        auto pending = m_pendingColumns.find(column);
+        if (pending == m_pendingColumns.end() || pending->second != job) continue;
+        m_pendingColumns.erase(pending);
+        
+        std::vector<ChunkPosition> generatedChunks;
+        if (job->loaded) {
+            generatedChunks = addLoadedColumn(m_chunkManager, job->stored);
+            m_loadedColumns++;
+        }
+        else {
+            generatedChunks = addGeneratedColumn(m_chunkManager, job->column);
+            m_unsavedColumns.insert(column);
+        }
+        
+        for (const ChunkPosition& pos : generatedChunks) {
+            requestChunkMesh(pos);
+        }
     }
 }
 
@@ -133,326 +307,339 @@ void VoxelWorld::generateTerrain(Chunk& chunk, const ChunkPosition& chunkPos) {
     // The terrain_generation.cpp system handles this better
 }
 
-void VoxelWorld::generateChunkMesh(const ChunkPosition& chunkPos) {
-    if (!m_chunkManager.hasChunk(chunkPos)) return;
+bool VoxelWorld::skipEmptyChunkMesh(const ChunkPosition& chunkPos) {
+    if (!isChunkMeshEmpty(m_chunkManager, m_voxelDataManager, chunkPos)) return false;
     
-    const Chunk& chunk = m_chunkManager.getChunk(chunkPos);
+    // Also drops meshes of the chunk that are still being built
+    removeChunkMesh(chunkPos);
+    m_skippedMeshes++;
+    return true;
+}
+
+void VoxelWorld::generateChunkMesh(const ChunkPosition& chunkPos) {
+    if (skipEmptyChunkMesh(chunkPos)) return;
     
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
-    unsigned int vertexOffset = 0;
+    ChunkMeshSnapshot* snapshot = m_snapshotPool.acquire();
+    if (fillChunkMeshSnapshot(m_chunkManager, chunkPos, *snapshot)) {
+        ChunkMesher mesher(m_voxelDataManager, m_blockModels, m_meshingMode, m_faceCullingMode);
+        mesher.build(*snapshot, m_meshScratch);
+        
+        // Anything still being meshed for this chunk is now out of date
+        m_meshVersions[chunkPos] = ++m_nextMeshVersion;
+        uploadChunkMesh(chunkPos, m_meshScratch);
+    }
+    m_snapshotPool.release(snapshot);
+}
+
+void VoxelWorld::requestChunkMesh(const ChunkPosition& chunkPos) {
+    if (skipEmptyChunkMesh(chunkPos)) return;
     
-    // Store current chunk info for face culling
-    m_currentChunk = &chunk;
-    m_currentChunkPos = chunkPos;
+    // The pool owns the snapshot, so it is freed with the pool if the job is discarded
+    ChunkMeshSnapshot* snapshot = m_snapshotPool.acquire();
+    if (!fillChunkMeshSnapshot(m_chunkManager, chunkPos, *snapshot)) {
+        m_snapshotPool.release(snapshot);
+        return;
+    }
     
-    // Generate mesh for each voxel in the chunk
-    for (int x = 0; x < CHUNK_SIZE; x++) {
-        for (int y = 0; y < CHUNK_SIZE; y++) {
-            for (int z = 0; z < CHUNK_SIZE; z++) {
-                VoxelPosition localPos = {x, y, z};
-                voxel_t voxel = chunk.qGetVoxel(localPos);
-                
-                // Skip air voxels
-                if (voxel == static_cast<voxel_t>(CommonVoxel::Air)) continue;
-                
-                // Get voxel data to determine mesh style
-                const VoxelData& voxelData = m_voxelDataManager.getVoxelData(voxel);
-                
-                // Skip voxels with no mesh
-                if (voxelData.meshStyle == VoxelMeshStyle::None) continue;
-                
-                createVoxelMesh(localPos, voxel, voxelData, vertices, indices, vertexOffset);
-            }
+    u32 version = ++m_nextMeshVersion;
+    m_meshVersions[chunkPos] = version;
+    VoxelMeshingMode meshingMode = m_meshingMode;
+    FaceCullingMode faceCullingMode = m_faceCullingMode;
+    
+    m_workers.submit([this, snapshot, version, meshingMode, faceCullingMode] {
+        ChunkMeshResult* result = m_meshResultPool.acquire();
+        result->position = snapshot->position;
+        result->version = version;
+        ChunkMesher mesher(m_voxelDataManager, m_blockModels, meshingMode, faceCullingMode);
+        mesher.build(*snapshot, result->data);
+        m_snapshotPool.release(snapshot);
+        
+        std::lock_guard<std::mutex> lock(m_completedMeshesMutex);
+        m_completedMeshes.push_back(result);
+    });
+}
+
+void VoxelWorld::uploadCompletedMeshes() {
+    std::size_t uploadedBytes = 0;
+    while (uploadedBytes < m_meshUploadBudget) {
+        ChunkMeshResult* result;
+        {
+            std::lock_guard<std::mutex> lock(m_completedMeshesMutex);
+            if (m_completedMeshes.empty()) break;
+            result = m_completedMeshes.front();
+            m_completedMeshes.pop_front();
+        }
+        
+        // Unless a newer request for this chunk is on its way, or the chunk was unloaded
+        auto version = m_meshVersions.find(result->position);
+        if (version != m_meshVersions.end() && version->second == result->version) {
+            uploadChunkMesh(result->position, result->data);
+            uploadedBytes += result->data.byteSize();
         }
+        m_meshResultPool.release(result);
     }
-    
+}
+
+void VoxelWorld::uploadChunkMesh(const ChunkPosition& chunkPos, const ChunkMeshData& data) {
     // Create or update mesh
     ChunkMesh& mesh = m_chunkMeshes[chunkPos];
+    bool wasEmpty = mesh.gpu.empty();
     mesh.position = chunkPos;
-    mesh.indexCount = static_cast<int>(indices.size());
+    m_peakMeshVertices = std::max(m_peakMeshVertices, static_cast<u32>(data.vertices.size()));
+    m_peakMeshIndices = std::max(m_peakMeshIndices, static_cast<u32>(data.indices.size()));
     
-    // Generate OpenGL buffers if they don't exist
-    if (mesh.VAO == 0) {
-        glGenVertexArrays(1, &mesh.VAO);
-        glGenBuffers(1, &mesh.VBO);
-        glGenBuffers(1, &mesh.EBO);
-    }
-    
-    // Upload mesh data
-    glBindVertexArray(mesh.VAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // Texture coordinate attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    glm::vec3 origin = glm::vec3(chunkPos.x, chunkPos.y, chunkPos.z) * static_cast<float>(CHUNK_SIZE);
+    m_meshUploader.upload(mesh.gpu, data, origin);
     
-    glBindVertexArray(0);
+    // Empty meshes are left out of the bounds array
+    if (mesh.gpu.empty() != wasEmpty) {
+        m_chunkBoundsDirty = true;
+    }
 }
 
-void VoxelWorld::createVoxelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                                std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                                unsigned int& vertexOffset) {
-    
-    switch (voxelData.meshStyle) {
-        case VoxelMeshStyle::Voxel:
-            createCubeMesh(localPos, voxelType, voxelData, vertices, indices, vertexOffset);
-            break;
-        case VoxelMeshStyle::Cross:
-            createCrossMesh(localPos, voxelType, voxelData, vertices, indices, vertexOffset);
-            break;
-        case VoxelMeshStyle::Model:
-            createModelMesh(localPos, voxelType, voxelData, vertices, indices, vertexOffset);
-            break;
-        case VoxelMeshStyle::None:
-            // No mesh to create
-            break;
-        default:
-            // Default to cube mesh
-            createCubeMesh(localPos, voxelType, voxelData, vertices, indices, vertexOffset);
-            break;
-    }
-}
-
-void VoxelWorld::createCubeMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                               std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                               unsigned int& vertexOffset) {
-    
-    float x = static_cast<float>(localPos.x);
-    float y = static_cast<float>(localPos.y);
-    float z = static_cast<float>(localPos.z);
-    
-    // Define the 6 faces with their direction indices
-    // 0=left(-X), 1=right(+X), 2=bottom(-Y), 3=top(+Y), 4=back(-Z), 5=front(+Z)
-    
-    // Check each face and only add it if it should be rendered
-    unsigned int currentVertexOffset = vertexOffset;
-    
-    // Front face (+Z)
-    if (shouldRenderFace(localPos, 5)) {
-        std::vector<float> faceVertices = {
-            x - 0.5f, y - 0.5f, z + 0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 0.0f,
-            x + 0.5f, y - 0.5f, z + 0.5f,  0.0f,  0.0f,  1.0f,  1.0f, 0.0f,
-            x + 0.5f, y + 0.5f, z + 0.5f,  0.0f,  0.0f,  1.0f,  1.0f, 1.0f,
-            x - 0.5f, y + 0.5f, z + 0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 1.0f,
-        };
-        std::vector<unsigned int> faceIndices = {
-            0, 1, 2, 2, 3, 0
-        };
-        
-        vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
-        for (unsigned int index : faceIndices) {
-            indices.push_back(index + currentVertexOffset);
+void VoxelWorld::evictColumns() {
+    const int keepDistance = m_renderDistance + m_unloadMargin;
+    auto columnDistance = [this](const ChunkPosition& pos) {
+        return std::max(std::abs(pos.x - m_lastCameraChunk.x), std::abs(pos.z - m_lastCameraChunk.z));
+    };
+    
+    // Columns between the render and unload distances, least recently used first
+    std::vector<std::pair<u64, ChunkPosition>> candidates;
+    for (const auto& [column, lastUsed] : m_requestedColumns) {
+        int distance = columnDistance(column);
+        if (distance > m_renderDistance && distance <= keepDistance) {
+            candidates.emplace_back(lastUsed, column);
         }
-        currentVertexOffset += 4;
     }
-    
-    // Back face (-Z)
-    if (shouldRenderFace(localPos, 4)) {
-        std::vector<float> faceVertices = {
-            x - 0.5f, y - 0.5f, z - 0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
-            x + 0.5f, y - 0.5f, z - 0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-            x + 0.5f, y + 0.5f, z - 0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
-            x - 0.5f, y + 0.5f, z - 0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-        };
-        std::vector<unsigned int> faceIndices = {
-            0, 1, 2, 2, 3, 0
-        };
-        
-        vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
-        for (unsigned int index : faceIndices) {
-            indices.push_back(index + currentVertexOffset);
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    
+    // Memory of each column, and of everything that stays if only the far columns go
+    ChunkPositionMap<std::size_t> columnChunkBytes;
+    ChunkPositionMap<std::size_t> columnMeshBytes;
+    std::size_t chunkBytes = 0;
+    std::size_t meshBytes = meshMemoryUsage();
+    std::vector<ChunkPosition> evictedChunks;
+    for (const auto& slot : m_chunkManager.chunks()) {
+        ChunkPosition column = {slot.position.x, 0, slot.position.z};
+        std::size_t bytes = slot.value->memoryUsage();
+        if (columnDistance(column) > keepDistance) {
+            evictedChunks.push_back(slot.position);
+            continue;
         }
-        currentVertexOffset += 4;
+        columnChunkBytes[column] += bytes;
+        chunkBytes += bytes;
     }
-    
-    // Left face (-X)
-    if (shouldRenderFace(localPos, 0)) {
-        std::vector<float> faceVertices = {
-            x - 0.5f, y - 0.5f, z - 0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-            x - 0.5f, y - 0.5f, z + 0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-            x - 0.5f, y + 0.5f, z + 0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-            x - 0.5f, y + 0.5f, z - 0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-        };
-        std::vector<unsigned int> faceIndices = {
-            0, 1, 2, 2, 3, 0
-        };
-        
-        vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
-        for (unsigned int index : faceIndices) {
-            indices.push_back(index + currentVertexOffset);
+    for (const auto& [pos, mesh] : m_chunkMeshes) {
+        ChunkPosition column = {pos.x, 0, pos.z};
+        std::size_t bytes = mesh.gpu.gpuBytes();
+        if (columnDistance(column) > keepDistance) {
+            meshBytes -= bytes;
+        }
+        else {
+            columnMeshBytes[column] += bytes;
         }
-        currentVertexOffset += 4;
     }
     
-    // Right face (+X)
-    if (shouldRenderFace(localPos, 1)) {
-        std::vector<float> faceVertices = {
-            x + 0.5f, y - 0.5f, z - 0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-            x + 0.5f, y - 0.5f, z + 0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-            x + 0.5f, y + 0.5f, z + 0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-            x + 0.5f, y + 0.5f, z - 0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-        };
-        std::vector<unsigned int> faceIndices = {
-            0, 1, 2, 2, 3, 0
-        };
-        
-        vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
-        for (unsigned int index : faceIndices) {
-            indices.push_back(index + currentVertexOffset);
+    ChunkPositionSet evictedColumns;
+    for (const auto& [column, lastUsed] : m_requestedColumns) {
+        if (columnDistance(column) > keepDistance) {
+            evictedColumns.insert(column);
         }
-        currentVertexOffset += 4;
     }
+    for (const auto& [lastUsed, column] : candidates) {
+        if (chunkBytes <= m_chunkMemoryBudget && meshBytes <= m_meshMemoryBudget) break;
+        evictedColumns.insert(column);
+        chunkBytes -= columnChunkBytes[column];
+        meshBytes -= columnMeshBytes[column];
+    }
+    if (evictedColumns.empty() && evictedChunks.empty()) return;
     
-    // Bottom face (-Y)
-    if (shouldRenderFace(localPos, 2)) {
-        std::vector<float> faceVertices = {
-            x - 0.5f, y - 0.5f, z - 0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-            x + 0.5f, y - 0.5f, z - 0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
-            x + 0.5f, y - 0.5f, z + 0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-            x - 0.5f, y - 0.5f, z + 0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
-        };
-        std::vector<unsigned int> faceIndices = {
-            0, 1, 2, 2, 3, 0
-        };
-        
-        vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
-        for (unsigned int index : faceIndices) {
-            indices.push_back(index + currentVertexOffset);
+    // Chunks of budget evicted columns, far ones were collected above
+    for (const auto& slot : m_chunkManager.chunks()) {
+        if (evictedColumns.count({slot.position.x, 0, slot.position.z}) > 0 &&
+            columnDistance(slot.position) <= keepDistance) {
+            evictedChunks.push_back(slot.position);
         }
-        currentVertexOffset += 4;
     }
     
-    // Top face (+Y)
-    if (shouldRenderFace(localPos, 3)) {
-        std::vector<float> faceVertices = {
-            x - 0.5f, y + 0.5f, z - 0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
-            x + 0.5f, y + 0.5f, z - 0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
-            x + 0.5f, y + 0.5f, z + 0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-            x - 0.5f, y + 0.5f, z + 0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
-        };
-        std::vector<unsigned int> faceIndices = {
-            0, 1, 2, 2, 3, 0
-        };
+    saveColumns(evictedChunks);
+    for (const ChunkPosition& pos : evictedChunks) {
+        m_chunkManager.removeChunk(pos);
+        removeChunkMesh(pos);
+    }
+    for (const ChunkPosition& column : evictedColumns) {
+        m_requestedColumns.erase(column);
         
-        vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
-        for (unsigned int index : faceIndices) {
-            indices.push_back(index + currentVertexOffset);
+        // Stop loading it, a job waiting on the I/O thread is finished with nothing
+        auto pending = m_pendingColumns.find(column);
+        if (pending != m_pendingColumns.end()) {
+            ColumnGenerationJob& job = *pending->second;
+            if (job.ioRequest != 0) {
+                m_chunkIO.cancelLoad(job.ioRequest);
+                job.done.store(true, std::memory_order_release);
+            }
+            m_pendingColumns.erase(pending);
         }
-        currentVertexOffset += 4;
     }
-    
-    vertexOffset = currentVertexOffset;
+    // Edits to columns that were never loaded are lost with the chunks
+    for (const ChunkPosition& pos : evictedChunks) {
+        m_unsavedColumns.erase({pos.x, 0, pos.z});
+    }
+    m_evictedColumns += evictedColumns.size();
+    m_evictedChunks += evictedChunks.size();
 }
 
-void VoxelWorld::createCrossMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                                std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                                unsigned int& vertexOffset) {
-    
-    float x = static_cast<float>(localPos.x);
-    float y = static_cast<float>(localPos.y);
-    float z = static_cast<float>(localPos.z);
-    
-    unsigned int currentVertexOffset = vertexOffset;
-    
-    // Create two intersecting planes to form a cross shape
-    // First plane: diagonal from (-0.5, -0.5, -0.5) to (0.5, 0.5, 0.5)
-    std::vector<float> plane1Vertices = {
-        x - 0.5f, y - 0.5f, z - 0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 0.0f,
-        x + 0.5f, y - 0.5f, z + 0.5f,  0.0f,  0.0f,  1.0f,  1.0f, 0.0f,
-        x + 0.5f, y + 0.5f, z + 0.5f,  0.0f,  0.0f,  1.0f,  1.0f, 1.0f,
-        x - 0.5f, y + 0.5f, z - 0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 1.0f,
-    };
-    
-    // Second plane: diagonal from (-0.5, -0.5, 0.5) to (0.5, 0.5, -0.5)
-    std::vector<float> plane2Vertices = {
-        x - 0.5f, y - 0.5f, z + 0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-        x + 0.5f, y - 0.5f, z - 0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
-        x + 0.5f, y + 0.5f, z - 0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-        x - 0.5f, y + 0.5f, z + 0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
-    };
-    
-    // Indices for both planes (need to render both sides)
-    std::vector<unsigned int> planeIndices = {
-        0, 1, 2, 2, 3, 0,  // Front face
-        2, 1, 0, 0, 3, 2   // Back face (reversed winding)
-    };
-    
-    // Add first plane
-    vertices.insert(vertices.end(), plane1Vertices.begin(), plane1Vertices.end());
-    for (unsigned int index : planeIndices) {
-        indices.push_back(index + currentVertexOffset);
+void VoxelWorld::saveWorld() {
+    std::vector<ChunkPosition> chunks;
+    chunks.reserve(m_chunkManager.chunks().size());
+    for (const auto& slot : m_chunkManager.chunks()) {
+        chunks.push_back(slot.position);
     }
-    currentVertexOffset += 4;
-    
-    // Add second plane
-    vertices.insert(vertices.end(), plane2Vertices.begin(), plane2Vertices.end());
-    for (unsigned int index : planeIndices) {
-        indices.push_back(index + currentVertexOffset);
+    saveColumns(chunks);
+    m_chunkIO.flush();
+}
+
+void VoxelWorld::saveColumns(const std::vector<ChunkPosition>& chunks) {
+    if (m_unsavedColumns.empty() || m_regionStorage.access() == RegionAccess::ReadOnly) return;
+    
+    // Only columns that finished loading, a partly built one would be stored as
+    // complete and never generated again
+    ChunkPositionMap<std::vector<int>> columnChunks;
+    for (const ChunkPosition& pos : chunks) {
+        ChunkPosition column = {pos.x, 0, pos.z};
+        if (m_unsavedColumns.count(column) > 0 && m_requestedColumns.count(column) > 0 &&
+            m_pendingColumns.count(column) == 0) {
+            columnChunks[column].push_back(pos.y);
+        }
     }
-    currentVertexOffset += 4;
     
-    vertexOffset = currentVertexOffset;
+    // Compressed here, written on the I/O thread
+    for (const auto& [column, chunkYs] : columnChunks) {
+        m_chunkIO.requestSave(storeColumn(m_chunkManager, column.x, column.z, chunkYs));
+        m_unsavedColumns.erase(column);
+        m_savedColumns++;
+    }
 }
 
-bool VoxelWorld::shouldRenderFace(const VoxelPosition& localPos, int direction) {
-    if (!m_currentChunk) return true; // Safety fallback
+void VoxelWorld::removeChunkMesh(const ChunkPosition& chunkPos) {
+    m_meshVersions.erase(chunkPos);
     
-    // Direction offsets: 0=left(-X), 1=right(+X), 2=bottom(-Y), 3=top(+Y), 4=back(-Z), 5=front(+Z)
-    VoxelPosition neighborPos = localPos;
+    auto it = m_chunkMeshes.find(chunkPos);
+    if (it == m_chunkMeshes.end()) return;
     
-    switch (direction) {
-        case 0: neighborPos.x -= 1; break; // Left (-X)
-        case 1: neighborPos.x += 1; break; // Right (+X)
-        case 2: neighborPos.y -= 1; break; // Bottom (-Y)
-        case 3: neighborPos.y += 1; break; // Top (+Y)
-        case 4: neighborPos.z -= 1; break; // Back (-Z)
-        case 5: neighborPos.z += 1; break; // Front (+Z)
-        default: return true;
+    m_meshUploader.release(it->second.gpu);
+    m_chunkMeshes.erase(it);
+    m_chunkBoundsDirty = true;
+}
+
+std::size_t VoxelWorld::meshMemoryUsage() const {
+    return m_meshUploader.usedBytes();
+}
+
+void VoxelWorld::rebuildChunkBounds() {
+    m_chunkBounds.clear();
+    m_chunkBoundsMeshes.clear();
+    for (auto& [pos, mesh] : m_chunkMeshes) {
+        if (mesh.gpu.empty()) continue;
+        
+        // Voxel geometry is offset by half a voxel, and block models may overhang a bit more
+        glm::vec3 origin = glm::vec3(pos.x, pos.y, pos.z) * static_cast<float>(CHUNK_SIZE);
+        m_chunkBounds.push_back({origin - 1.0f, origin + static_cast<float>(CHUNK_SIZE + 1)});
+        m_chunkBoundsMeshes.push_back(&mesh);
     }
+    m_chunkBoundsDirty = false;
+}
+
+void VoxelWorld::setMeshingMode(VoxelMeshingMode mode) {
+    if (mode == m_meshingMode) return;
+    m_meshingMode = mode;
     
-    // Check if neighbor position is within current chunk bounds
-    if (neighborPos.x >= 0 && neighborPos.x < CHUNK_SIZE &&
-        neighborPos.y >= 0 && neighborPos.y < CHUNK_SIZE &&
-        neighborPos.z >= 0 && neighborPos.z < CHUNK_SIZE) {
-        
-        // Neighbor is within current chunk
-        voxel_t neighborVoxel = m_currentChunk->qGetVoxel(neighborPos);
-        return neighborVoxel == static_cast<voxel_t>(CommonVoxel::Air);
-    } else {
-        // Neighbor is in a different chunk - need to check across chunk boundaries
-        VoxelPosition worldPos = {
-            m_currentChunkPos.x * CHUNK_SIZE + neighborPos.x,
-            m_currentChunkPos.y * CHUNK_SIZE + neighborPos.y,
-            m_currentChunkPos.z * CHUNK_SIZE + neighborPos.z
-        };
-        
-        // Get the chunk that contains this world position
-        ChunkPosition neighborChunkPos = toChunkPosition(worldPos);
-        
-        // Check if the neighboring chunk exists
-        if (!m_chunkManager.hasChunk(neighborChunkPos)) {
-            // No neighboring chunk loaded - render the face (assume air)
-            return true;
-        }
-        
-        // Get the neighbor voxel from the neighboring chunk
-        voxel_t neighborVoxel = m_chunkManager.getVoxel(worldPos);
-        return neighborVoxel == static_cast<voxel_t>(CommonVoxel::Air);
+    // Rebuild every existing mesh so both modes can be compared on the same world
+    remeshAllChunks();
+}
+
+void VoxelWorld::remeshAllChunks() {
+    // Requests can drop meshes that turn out empty, so don't iterate the meshes themselves
+    std::vector<ChunkPosition> positions;
+    positions.reserve(m_chunkMeshes.size());
+    for (const auto& [pos, mesh] : m_chunkMeshes) {
+        positions.push_back(pos);
     }
+    for (const ChunkPosition& pos : positions) {
+        requestChunkMesh(pos);
+    }
+}
+
+VoxelMeshingMode VoxelWorld::getMeshingMode() const {
+    return m_meshingMode;
+}
+
+void VoxelWorld::setFaceCullingMode(FaceCullingMode mode) {
+    if (mode == m_faceCullingMode) return;
+    m_faceCullingMode = mode;
+    
+    remeshAllChunks();
+}
+
+FaceCullingMode VoxelWorld::getFaceCullingMode() const {
+    return m_faceCullingMode;
+}
+
+void VoxelWorld::setMeshUploadBudget(std::size_t bytesPerFrame) {
+    m_meshUploadBudget = bytesPerFrame;
+}
+
+void VoxelWorld::setMeshBufferPoolSize(std::size_t snapshots, std::size_t results) {
+    m_snapshotPool.setMaxIdle(snapshots);
+    m_meshResultPool.setMaxIdle(results);
+}
+
+void VoxelWorld::setRemeshTimeBudget(float milliseconds) {
+    m_remeshTimeBudget = milliseconds;
+}
+
+void VoxelWorld::setMemoryBudget(std::size_t chunkBytes, std::size_t meshBytes) {
+    m_chunkMemoryBudget = chunkBytes;
+    m_meshMemoryBudget = meshBytes;
+    evictColumns();
+}
+
+void VoxelWorld::setUnloadMargin(int columns) {
+    m_unloadMargin = std::max(columns, 0);
+}
+
+void VoxelWorld::setStorageAccess(RegionAccess access) {
+    m_regionStorage.setAccess(access);
+}
+
+WorldResidencyStats VoxelWorld::getResidencyStats() const {
+    WorldResidencyStats stats;
+    stats.columns = static_cast<u32>(m_requestedColumns.size());
+    stats.chunks = static_cast<u32>(m_chunkManager.chunks().size());
+    stats.meshes = static_cast<u32>(m_chunkMeshes.size());
+    stats.chunkBytes = m_chunkManager.memoryUsage();
+    stats.meshBytes = meshMemoryUsage();
+    stats.evictedColumns = m_evictedColumns;
+    stats.evictedChunks = m_evictedChunks;
+    stats.loadedColumns = m_loadedColumns;
+    stats.savedColumns = m_savedColumns;
+    stats.skippedMeshes = m_skippedMeshes;
+    return stats;
+}
+
+const ChunkCullingStats& VoxelWorld::getCullingStats() const {
+    return m_cullingStats;
+}
+
+MeshBufferStats VoxelWorld::getMeshBufferStats() const {
+    MeshBufferStats stats;
+    stats.snapshots = m_snapshotPool.stats();
+    stats.results = m_meshResultPool.stats();
+    stats.peakVertices = m_peakMeshVertices;
+    stats.peakIndices = m_peakMeshIndices;
+    return stats;
 }
 
 voxel_t VoxelWorld::getVoxel(const VoxelPosition& position) const {
@@ -460,14 +647,124 @@ voxel_t VoxelWorld::getVoxel(const VoxelPosition& position) const {
 }
 
 void VoxelWorld::setVoxel(const VoxelPosition& position, voxel_t voxel) {
+    if (m_chunkManager.getVoxel(position) == voxel) return;
     m_chunkManager.setVoxel(position, voxel);
     
-    // Mark chunk mesh for update
     ChunkPosition chunkPos = toChunkPosition(position);
-    auto it = m_chunkMeshes.find(chunkPos);
-    if (it != m_chunkMeshes.end()) {
-        it->second.needsUpdate = true;
+    m_unsavedColumns.insert({chunkPos.x, 0, chunkPos.z});
+    markChunkDirty(chunkPos);
+    
+    // Voxels on the chunk border also show or hide faces of the 1 to 3 chunks they touch
+    VoxelPosition local = toLocalVoxelPosition(position);
+    const int localAxes[3] = {local.x, local.y, local.z};
+    for (int axis = 0; axis < 3; axis++) {
+        if (localAxes[axis] == 0) {
+            markChunkDirty(neighbourChunkPosition(chunkPos, axis * 2));
+        }
+        else if (localAxes[axis] == CHUNK_SIZE - 1) {
+            markChunkDirty(neighbourChunkPosition(chunkPos, axis * 2 + 1));
+        }
+    }
+}
+
+void VoxelWorld::fillBox(const VoxelPosition& min, const VoxelPosition& max, voxel_t voxel) {
+    markEditedChunks(::fillBox(m_chunkManager, min, max, voxel), min, max);
+}
+
+void VoxelWorld::fillSphere(const VoxelPosition& centre, int radius, voxel_t voxel) {
+    VoxelPosition min(centre.x - radius, centre.y - radius, centre.z - radius);
+    VoxelPosition max(centre.x + radius, centre.y + radius, centre.z + radius);
+    markEditedChunks(::fillSphere(m_chunkManager, centre, radius, voxel), min, max);
+}
+
+void VoxelWorld::replaceVoxels(const VoxelPosition& min, const VoxelPosition& max, voxel_t from, voxel_t to) {
+    markEditedChunks(::replaceVoxels(m_chunkManager, min, max, from, to), min, max);
+}
+
+void VoxelWorld::pasteVoxels(const VoxelPosition& origin, const VoxelBuffer& buffer, bool pasteAir) {
+    VoxelPosition max(origin.x + buffer.size.x - 1, origin.y + buffer.size.y - 1, origin.z + buffer.size.z - 1);
+    markEditedChunks(::pasteVoxels(m_chunkManager, origin, buffer, pasteAir), origin, max);
+}
+
+VoxelBuffer VoxelWorld::copyVoxels(const VoxelPosition& min, const VoxelPosition& max) const {
+    return ::copyVoxels(m_chunkManager, min, max);
+}
+
+VoxelRayHit VoxelWorld::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                                const VoxelRayFilter& filter) const {
+    return raycastVoxels(m_chunkManager, origin, direction, maxDistance, filter);
+}
+
+const VoxelDataManager& VoxelWorld::getVoxelDataManager() const {
+    return m_voxelDataManager;
+}
+
+void VoxelWorld::markEditedChunks(const std::vector<ChunkPosition>& changed, const VoxelPosition& min,
+                                  const VoxelPosition& max) {
+    const int boxMin[3] = {min.x, min.y, min.z};
+    const int boxMax[3] = {max.x, max.y, max.z};
+    for (const ChunkPosition& chunkPos : changed) {
+        m_unsavedColumns.insert({chunkPos.x, 0, chunkPos.z});
+        markChunkDirty(chunkPos);
+        
+        // Neighbours only see this chunk's border voxels
+        const int chunkOrigin[3] = {chunkPos.x * CHUNK_SIZE, chunkPos.y * CHUNK_SIZE, chunkPos.z * CHUNK_SIZE};
+        for (int axis = 0; axis < 3; axis++) {
+            if (boxMin[axis] <= chunkOrigin[axis]) {
+                markChunkDirty(neighbourChunkPosition(chunkPos, axis * 2));
+            }
+            if (boxMax[axis] >= chunkOrigin[axis] + CHUNK_SIZE - 1) {
+                markChunkDirty(neighbourChunkPosition(chunkPos, axis * 2 + 1));
+            }
+        }
+    }
+}
+
+void VoxelWorld::markChunkDirty(const ChunkPosition& chunkPos) {
+    if (m_dirtyChunkSet.insert(chunkPos).second) {
+        m_dirtyChunks.push_back(chunkPos);
+    }
+}
+
+void VoxelWorld::remeshDirtyChunks() {
+    if (m_dirtyChunks.empty()) return;
+    
+    // Nearest first, the edits the player is looking at show up this frame
+    std::stable_sort(m_dirtyChunks.begin(), m_dirtyChunks.end(),
+                     [this](const ChunkPosition& a, const ChunkPosition& b) {
+        auto distance = [this](const ChunkPosition& pos) {
+            int dx = pos.x - m_lastCameraChunk.x;
+            int dy = pos.y - m_lastCameraChunk.y;
+            int dz = pos.z - m_lastCameraChunk.z;
+            return dx * dx + dy * dy + dz * dz;
+        };
+        return distance(a) < distance(b);
+    });
+    
+    auto start = std::chrono::steady_clock::now();
+    std::size_t remeshed = 0;
+    while (remeshed < m_dirtyChunks.size()) {
+        updateChunkMesh(m_dirtyChunks[remeshed++]);
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= m_remeshTimeBudget) break;
+    }
+    
+    // Waiting for later frames would delay them by a frame per budget's worth
+    for (std::size_t i = remeshed; i < m_dirtyChunks.size(); i++) {
+        if (m_chunkManager.hasChunk(m_dirtyChunks[i])) {
+            requestChunkMesh(m_dirtyChunks[i]);
+        }
     }
+    m_dirtyChunks.clear();
+    m_dirtyChunkSet.clear();
+}
+
+void VoxelWorld::updateChunkMesh(const ChunkPosition& chunkPos) {
+    if (!m_chunkManager.hasChunk(chunkPos)) {
+        removeChunkMesh(chunkPos);
+        return;
+    }
+    generateChunkMesh(chunkPos);
 }
 
 void VoxelWorld::loadBlockModels() {
@@ -496,10 +793,20 @@ void VoxelWorld::loadBlockModels() {
                 continue;
             }
             
-            // Store the model in the map using the path as key
-            m_blockModels[modelPath] = std::move(model);
+            // The mesher only reads the geometry of the first mesh
+            const Mesh& mesh = model->meshes[0];
+            BlockModelGeometry& geometry = m_blockModels[modelPath];
+            geometry.vertices.clear();
+            for (const Vertex& vertex : mesh.vertices) {
+                geometry.vertices.insert(geometry.vertices.end(), {
+                    vertex.Position.x, vertex.Position.y, vertex.Position.z,
+                    vertex.Normal.x, vertex.Normal.y, vertex.Normal.z,
+                    vertex.TexCoords.x, vertex.TexCoords.y
+                });
+            }
+            geometry.indices = mesh.indices;
             
-            std::cout << "SUCCESS: Loaded model: " << modelPath << " with " << m_blockModels[modelPath]->meshes.size() << " meshes" << std::endl;
+            std::cout << "SUCCESS: Loaded model: " << modelPath << " with " << model->meshes.size() << " meshes" << std::endl;
         } catch (const std::exception& e) {
             std::cerr << "ERROR: Failed to load model: " << modelPath << " - " << e.what() << std::endl;
         }
@@ -508,71 +815,3 @@ void VoxelWorld::loadBlockModels() {
     std::cout << "Model loading complete. Loaded " << m_blockModels.size() << " models." << std::endl;
 }
 
-void VoxelWorld::createModelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                                std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                                unsigned int& vertexOffset) {
-    
-    if (voxelData.modelPath.empty()) {
-        // Fallback to regular cube mesh if no model path is specified
-        createCubeMesh(localPos, voxelType, voxelData, vertices, indices, vertexOffset);
-        return;
-    }
-    
-    // Check if the model is loaded
-    auto modelIt = m_blockModels.find(voxelData.modelPath);
-    if (modelIt == m_blockModels.end()) {
-        // Model not found, fallback to cube mesh
-        std::cerr << "Model not found: " << voxelData.modelPath << ", using cube mesh fallback" << std::endl;
-        createCubeMesh(localPos, voxelType, voxelData, vertices, indices, vertexOffset);
-        return;
-    }
-    
-    Model* model = modelIt->second.get();
-    
-    // Get the position for this voxel
-    float x = localPos.x;
-    float y = localPos.y;
-    float z = localPos.z;
-    
-    // Extract vertex data from the model's first mesh
-    // Note: This assumes the model has at least one mesh
-    if (model->meshes.empty()) {
-        std::cerr << "Model has no meshes: " << voxelData.modelPath << ", using cube mesh fallback" << std::endl;
-        createCubeMesh(localPos, voxelType, voxelData, vertices, indices, vertexOffset);
-        return;
-    }
-    
-    // Use the first mesh from the model
-    const Mesh& modelMesh = model->meshes[0];
-    
-    // Convert model vertices to our vertex format and translate to voxel position
-    std::vector<float> modelVertices;
-    for (const auto& vertex : modelMesh.vertices) {
-        // Position (translated to voxel position)
-        modelVertices.push_back(vertex.Position.x + x);
-        modelVertices.push_back(vertex.Position.y + y);
-        modelVertices.push_back(vertex.Position.z + z);
-        
-        // Normal
-        modelVertices.push_back(vertex.Normal.x);
-        modelVertices.push_back(vertex.Normal.y);
-        modelVertices.push_back(vertex.Normal.z);
-        
-        // Texture coordinates
-        modelVertices.push_back(vertex.TexCoords.x);
-        modelVertices.push_back(vertex.TexCoords.y);
-    }
-    
-    // Copy and adjust indices
-    std::vector<unsigned int> modelIndices = modelMesh.indices;
-    for (auto& index : modelIndices) {
-        index += vertexOffset;
-    }
-    
-    // Add vertices and indices to the main vectors
-    vertices.insert(vertices.end(), modelVertices.begin(), modelVertices.end());
-    indices.insert(indices.end(), modelIndices.begin(), modelIndices.end());
-    
-    // Update vertex offset for next mesh
-    vertexOffset += modelMesh.vertices.size();
-}
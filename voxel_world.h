@@ -3,13 +3,61 @@
 #include "world/chunk_manager.h"
 #include "world/coordinate.h"
 #include "world/voxel_data.h"
+#include "world/thread_pool.h"
+#include "world/terrain_generation.h"
+#include "world/region_file.h"
+#include "world/chunk_io.h"
+#include "world/voxel_edits.h"
+#include "world/voxel_raycast.h"
+#include "world/chunk_mesher.h"
+#include "world/object_pool.h"
+#include "frustum.h"
+#include "chunk_mesh_uploader.h"
+#include "block_texture_array.h"
 #include "shader.h"
 #include "camera.h"
-#include "model.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief Chunk frustum culling counters of the last render() call
+ */
+struct ChunkCullingStats {
+    u32 tested = 0;     // Chunks with geometry that were tested against the frustum
+    u32 culled = 0;     // Chunks skipped because they were outside the frustum
+    u32 drawn = 0;      // Chunks that were drawn
+};
+
+/**
+ * @brief What the world currently holds in memory
+ */
+struct WorldResidencyStats {
+    u32 columns = 0;            // Columns generated or being generated
+    u32 chunks = 0;             // Chunks in the chunk manager, including empty neighbours
+    u32 meshes = 0;             // Chunks with uploaded geometry
+    std::size_t chunkBytes = 0; // RAM used by chunk voxels
+    std::size_t meshBytes = 0;  // GPU memory used by chunk geometry
+    u64 evictedColumns = 0;     // Columns unloaded since the world was created
+    u64 evictedChunks = 0;      // Chunks unloaded since the world was created
+    u64 loadedColumns = 0;      // Columns read from the region files instead of generated
+    u64 savedColumns = 0;       // Columns queued to be written to the region files
+    u64 skippedMeshes = 0;      // Mesh requests dropped because the chunk is uniform and has no visible faces
+};
+
+/**
+ * @brief Reuse of the buffers chunk meshing fills, for sizing the pools
+ */
+struct MeshBufferStats {
+    ObjectPoolStats snapshots;  // Chunk and neighbour copies waiting for or being meshed
+    ObjectPoolStats results;    // Built geometry waiting for or being uploaded
+    u32 peakVertices = 0;       // Most voxel vertices uploaded for one chunk
+    u32 peakIndices = 0;        // Most voxel indices uploaded for one chunk
+};
 
 /**
  * @brief Main voxel world class that handles chunk rendering and management
@@ -55,12 +103,28 @@ public:
     void generateChunk(const ChunkPosition& chunkPos);
 
     /**
-     * @brief Generate terrain for an entire chunk column (X, Z)
+     * @brief Generate terrain for an entire chunk column (X, Z) immediately
      * @param chunkX X coordinate of the chunk column
      * @param chunkZ Z coordinate of the chunk column
      */
     void generateChunkColumn(int chunkX, int chunkZ);
 
+    /**
+     * @brief Load a chunk column on the I/O thread, or generate it on the workers
+     * if it was never stored. Finished columns are added to the world by update() in
+     * the order they were requested, so the result is the same as calling
+     * generateChunkColumn in that order
+     * @param chunkX X coordinate of the chunk column
+     * @param chunkZ Z coordinate of the chunk column
+     */
+    void requestChunkColumn(int chunkX, int chunkZ);
+
+    /**
+     * @brief Write every loaded column that was generated or edited since it was
+     * last saved to the region files. Unloaded columns are saved as they are unloaded.
+     */
+    void saveWorld();
+
     /**
      * @brief Get voxel at world position
      * @param position World position
@@ -70,95 +134,395 @@ public:
 
     /**
      * @brief Set voxel at world position
+     * The chunk, and the neighbours that touch the voxel, are remeshed by the next
+     * update() however many voxels are set before it
      * @param position World position
      * @param voxel Voxel type to set
      */
     void setVoxel(const VoxelPosition& position, voxel_t voxel);
 
+    /**
+     * @brief Set every voxel in a box
+     * Like setVoxel, the changed chunks and the neighbours that touch the changes are
+     * remeshed once by the next update(). Prefer this and the other bulk edits to
+     * many setVoxel calls, they write whole rows of each chunk at once.
+     * @param min The lowest corner of the box
+     * @param max The highest corner of the box, inclusive
+     * @param voxel Voxel type to set
+     */
+    void fillBox(const VoxelPosition& min, const VoxelPosition& max, voxel_t voxel);
+
+    /**
+     * @brief Set every voxel within a radius of a voxel
+     * @param centre The voxel at the centre of the sphere
+     * @param radius The radius in voxels
+     * @param voxel Voxel type to set
+     */
+    void fillSphere(const VoxelPosition& centre, int radius, voxel_t voxel);
+
+    /**
+     * @brief Change every voxel of one type in a box to another type
+     * @param min The lowest corner of the box
+     * @param max The highest corner of the box, inclusive
+     * @param from Voxel type to replace
+     * @param to Voxel type to replace it with
+     */
+    void replaceVoxels(const VoxelPosition& min, const VoxelPosition& max, voxel_t from, voxel_t to);
+
+    /**
+     * @brief Copy a box of voxels into the world
+     * @param origin Where the buffer's lowest corner goes
+     * @param buffer The voxels to paste, from copyVoxels or built by hand
+     * @param pasteAir False to keep the world's voxels where the buffer has air
+     */
+    void pasteVoxels(const VoxelPosition& origin, const VoxelBuffer& buffer, bool pasteAir = true);
+
+    /**
+     * @brief Copy a box of voxels out of the world
+     * @param min The lowest corner of the box
+     * @param max The highest corner of the box, inclusive
+     * @return VoxelBuffer The voxels, unloaded chunks read as air
+     */
+    VoxelBuffer copyVoxels(const VoxelPosition& min, const VoxelPosition& max) const;
+
+    /**
+     * @brief Find the first voxel along a ray, for block picking and line of sight
+     * @param origin Where the ray starts
+     * @param direction Direction of the ray, does not need to be normalised
+     * @param maxDistance How far to look
+     * @param filter Which voxels stop the ray, eg VoxelRayFilter::collidable
+     * @return VoxelRayHit The voxel that was hit, and the face it was hit on
+     */
+    VoxelRayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                        const VoxelRayFilter& filter) const;
+
+    /**
+     * @brief The voxel types of the world, to build ray filters from
+     */
+    const VoxelDataManager& getVoxelDataManager() const;
+
+    /**
+     * @brief Select how solid blocks are meshed, remeshing loaded chunks if it changed
+     * @param mode The meshing mode to use
+     */
+    void setMeshingMode(VoxelMeshingMode mode);
+
+    VoxelMeshingMode getMeshingMode() const;
+
+    /**
+     * @brief Select how visible faces are found, remeshing loaded chunks if it changed
+     * Both modes produce identical meshes
+     * @param mode The face culling mode to use
+     */
+    void setFaceCullingMode(FaceCullingMode mode);
+
+    FaceCullingMode getFaceCullingMode() const;
+
+    /**
+     * @brief Limit how much finished chunk geometry is uploaded to the GPU each frame
+     * At least one chunk is uploaded per frame, however large it is
+     * @param bytesPerFrame Upload budget in bytes
+     */
+    void setMeshUploadBudget(std::size_t bytesPerFrame);
+
+    /**
+     * @brief How many meshing buffers are kept for reuse once they are no longer needed
+     * Requests beyond these allocate new buffers, see getMeshBufferStats for the peaks
+     * @param snapshots Chunk and neighbour copies, about 39 KB each
+     * @param results Built geometry, as large as the chunks they held
+     */
+    void setMeshBufferPoolSize(std::size_t snapshots, std::size_t results);
+
+    /**
+     * @brief Limit how long update() spends remeshing chunks changed by setVoxel
+     * At least one chunk is remeshed per frame, the ones left over are remeshed on
+     * the mesh workers instead
+     * @param milliseconds Remesh budget per frame
+     */
+    void setRemeshTimeBudget(float milliseconds);
+
+    /**
+     * @brief Limit the memory used by loaded columns outside the render distance
+     * Columns further than the render distance plus the unload margin are always
+     * unloaded. Columns between the two are kept while both budgets allow, and the
+     * ones that left the render distance longest ago are unloaded first when not.
+     * Columns inside the render distance are never unloaded.
+     * @param chunkBytes Budget for chunk voxels in RAM
+     * @param meshBytes Budget for chunk geometry on the GPU
+     */
+    void setMemoryBudget(std::size_t chunkBytes, std::size_t meshBytes);
+
+    /**
+     * @brief How many columns past the render distance are kept loaded, so that
+     * moving back and forth over a chunk border does not reload the columns there
+     * @param columns The margin in columns
+     */
+    void setUnloadMargin(int columns);
+
+    /**
+     * @brief Load and save columns, or only load them when several processes
+     * share one world directory
+     * @param access How region files are opened from now on
+     */
+    void setStorageAccess(RegionAccess access);
+
+    /**
+     * @brief Count what is loaded, walks every chunk
+     * @return WorldResidencyStats The counts
+     */
+    WorldResidencyStats getResidencyStats() const;
+
+    /**
+     * @brief Chunk frustum culling counters of the last frame
+     * @return const ChunkCullingStats& The counters
+     */
+    const ChunkCullingStats& getCullingStats() const;
+
+    /**
+     * @brief How many meshing buffers were allocated, and the most used at once
+     * @return MeshBufferStats The counts and high-water marks
+     */
+    MeshBufferStats getMeshBufferStats() const;
+
 private:
     ChunkManager m_chunkManager;
     VoxelDataManager m_voxelDataManager;
     int m_renderDistance;
     int m_worldSeed;
     int m_worldSize;
+    VoxelMeshingMode m_meshingMode;
+    FaceCullingMode m_faceCullingMode;
     
     // Model loading and management
-    std::unordered_map<std::string, std::unique_ptr<Model>> m_blockModels;
-    
-    // Current chunk being processed (for face culling)
-    const Chunk* m_currentChunk;
-    ChunkPosition m_currentChunkPos;
+    BlockModelMap m_blockModels;
     
     // Chunk mesh data
     struct ChunkMesh {
-        GLuint VAO, VBO, EBO;
-        int indexCount;
-        bool needsUpdate;
+        ChunkGpuMesh gpu;
         ChunkPosition position;
     };
     
+    // Geometry built on a mesh worker, waiting for upload on the render thread
+    struct ChunkMeshResult {
+        ChunkPosition position;
+        u32 version;
+        ChunkMeshData data;
+    };
+    
     std::unordered_map<ChunkPosition, ChunkMesh, ChunkPositionHash> m_chunkMeshes;
+    ChunkMeshUploader m_meshUploader;
+    
+    // Texture unit of the arena's chunk origins while rendering, clear of the material units
+    static constexpr int CHUNK_ORIGIN_TEXTURE_UNIT = 15;
+    
+    // Every block texture, bound once per frame for all voxel geometry
+    BlockTextureArray m_blockTextures;
+    static constexpr int BLOCK_TEXTURE_UNIT = 14;
+    
+    // Uniforms render() sets, resolved for the last shader program it was given
+    struct RenderUniforms {
+        unsigned int program = 0;
+        ShaderUniform<glm::mat4> view;
+        ShaderUniform<glm::mat4> projection;
+        ShaderUniform<glm::mat4> model;
+        ShaderUniform<bool> packedVertex;
+        ShaderUniform<int> chunkOrigins;
+        ShaderUniform<int> blockTextures;
+    };
+    RenderUniforms m_uniforms;
+    
+    // World space bounds of every chunk mesh, contiguous so they are culled in one pass
+    // m_chunkBoundsMeshes[i] is the mesh of m_chunkBounds[i], map nodes don't move
+    std::vector<AABB> m_chunkBounds;
+    std::vector<ChunkMesh*> m_chunkBoundsMeshes;
+    bool m_chunkBoundsDirty;
+    std::vector<u32> m_visibleChunks;
+    ChunkCullingStats m_cullingStats;
+    
+    // Latest mesh request of each chunk, results of older requests are dropped
+    ChunkPositionMap<u32> m_meshVersions;
+    
+    // Filled by mesh workers, drained by uploadCompletedMeshes
+    std::deque<ChunkMeshResult*> m_completedMeshes;
+    std::mutex m_completedMeshesMutex;
+    std::size_t m_meshUploadBudget;
+    
+    // Snapshots and results are recycled, so their buffers are already sized from
+    // earlier chunks instead of being allocated and grown for every mesh
+    ObjectPool<ChunkMeshSnapshot> m_snapshotPool;
+    ObjectPool<ChunkMeshResult> m_meshResultPool;
+    // Geometry of chunks meshed on the render thread
+    ChunkMeshData m_meshScratch;
+    u32 m_peakMeshVertices;
+    u32 m_peakMeshIndices;
+    
+    // A column being loaded or generated on a worker
+    struct ColumnGenerationJob {
+        int chunkX = 0;
+        int chunkZ = 0;
+        // Load on the I/O thread, 0 once it finished
+        u64 ioRequest = 0;
+        // Set when the column was read from the region files, column is left empty
+        bool loaded = false;
+        LoadedColumn stored;
+        GeneratedColumn column;
+        std::atomic<bool> done{false};
+    };
+    
+    // In request order, merged into the chunk manager from the front as they finish
+    std::deque<std::shared_ptr<ColumnGenerationJob>> m_columnJobs;
+    
+    // Columns that are generated or being generated, with y = 0
+    // Mapped to the last update() they were inside the render distance
+    ChunkPositionMap<u64> m_requestedColumns;
+    u64 m_updateCount;
+    
+    // Requested columns whose job has not been merged yet
+    ChunkPositionMap<std::shared_ptr<ColumnGenerationJob>> m_pendingColumns;
+    
+    // Columns that were generated or edited since they were last saved, with y = 0
+    ChunkPositionSet m_unsavedColumns;
+    RegionStorage m_regionStorage;
+    // Region file loads and saves, destroyed before the storage it uses
+    ChunkIO m_chunkIO;
+    u64 m_loadedColumns;
+    u64 m_savedColumns;
+    
+    // Unloading of columns away from the camera
+    std::size_t m_chunkMemoryBudget;
+    std::size_t m_meshMemoryBudget;
+    int m_unloadMargin;
+    u64 m_evictedColumns;
+    u64 m_evictedChunks;
+    
+    // Mesh versions come from one counter, so results for an unloaded chunk never
+    // match a later request for a chunk loaded at the same position
+    u32 m_nextMeshVersion;
+    u64 m_skippedMeshes;
+    
+    /**
+     * @brief Drop the mesh of a chunk that would mesh to nothing, instead of meshing it
+     * Chunks of air, and solid chunks buried in solid neighbours, make up most of a
+     * column and never need their voxels copied or scanned
+     * @param chunkPos Position of the chunk
+     * @return true The chunk has no geometry, and no longer has a mesh
+     */
+    bool skipEmptyChunkMesh(const ChunkPosition& chunkPos);
     
     /**
-     * @brief Generate mesh for a chunk
+     * @brief Generate and upload mesh for a chunk immediately
      * @param chunkPos Position of the chunk
      */
     void generateChunkMesh(const ChunkPosition& chunkPos);
     
     /**
-     * @brief Update mesh for a chunk
+     * @brief Mesh a chunk on the mesh workers, uploading it in a later frame
+     * The chunk and its neighbours are copied, so it can keep changing meanwhile
      * @param chunkPos Position of the chunk
      */
-    void updateChunkMesh(const ChunkPosition& chunkPos);
+    void requestChunkMesh(const ChunkPosition& chunkPos);
     
     /**
-     * @brief Generate simple terrain for a chunk
-     * @param chunk Reference to the chunk to fill
+     * @brief Add finished columns to the chunk manager in request order and mesh them
+     */
+    void mergeGeneratedColumns();
+    
+    /**
+     * @brief Take finished loads from the I/O thread, generating the columns that
+     * were not stored on the workers
+     */
+    void receiveLoadedColumns();
+    
+    /**
+     * @brief Upload finished meshes from the workers, within the per-frame upload budget
+     */
+    void uploadCompletedMeshes();
+    
+    /**
+     * @brief Unload columns outside the unload distance, then columns outside the
+     * render distance in least recently used order while over the memory budget
+     */
+    void evictColumns();
+    
+    /**
+     * @brief Save the unsaved columns among the given chunks' columns
+     * A column is stored with just the chunks passed for it, so pass all of them
+     * @param chunks Positions of the chunks
+     */
+    void saveColumns(const std::vector<ChunkPosition>& chunks);
+    
+    /**
+     * @brief Free the GPU geometry of a chunk and forget its mesh
      * @param chunkPos Position of the chunk
      */
-    void generateTerrain(Chunk& chunk, const ChunkPosition& chunkPos);
+    void removeChunkMesh(const ChunkPosition& chunkPos);
     
     /**
-     * @brief Create cube vertices for a voxel at local position
-     * @param localPos Local position within chunk
-     * @param voxelType Type of voxel
-     * @param voxelData Data for the voxel (mesh style, textures, etc.)
-     * @param vertices Output vertex data
-     * @param indices Output index data
-     * @param vertexOffset Current vertex offset for indices
+     * @brief GPU memory used by chunk geometry
      */
-    void createVoxelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                        std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                        unsigned int& vertexOffset);
-
+    std::size_t meshMemoryUsage() const;
+    
     /**
-     * @brief Create cube mesh for solid blocks
+     * @brief Rebuild the chunk bounds array after meshes were added or removed
      */
-    void createCubeMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                       std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                       unsigned int& vertexOffset);
-
+    void rebuildChunkBounds();
+    
     /**
-     * @brief Create cross mesh for plants/vegetation
+     * @brief Create or update the GPU buffers of a chunk
+     * @param chunkPos Position of the chunk
+     * @param data Geometry to upload
      */
-    void createCrossMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                        std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                        unsigned int& vertexOffset);
-                        
+    void uploadChunkMesh(const ChunkPosition& chunkPos, const ChunkMeshData& data);
+    
     /**
-     * @brief Create mesh from loaded 3D model
+     * @brief Mesh every chunk that has a mesh again on the mesh workers
      */
-    void createModelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
-                        std::vector<float>& vertices, std::vector<unsigned int>& indices, 
-                        unsigned int& vertexOffset);
+    void remeshAllChunks();
     
     /**
-     * @brief Check if a face should be rendered (is the adjacent voxel transparent?)
-     * @param localPos Local position within chunk
-     * @param direction Direction to check (0=left, 1=right, 2=bottom, 3=top, 4=back, 5=front)
-     * @return true if face should be rendered
+     * @brief Remesh a chunk now, or drop its mesh if the chunk was unloaded
+     * @param chunkPos Position of the chunk
      */
-    bool shouldRenderFace(const VoxelPosition& localPos, int direction);
+    void updateChunkMesh(const ChunkPosition& chunkPos);
+    
+    /**
+     * @brief Queue a chunk to be remeshed by the next update(), once however often
+     * it is marked before then
+     * @param chunkPos Position of the chunk
+     */
+    void markChunkDirty(const ChunkPosition& chunkPos);
+    
+    /**
+     * @brief Mark chunks changed by a bulk edit dirty, with the neighbours across
+     * the borders the edit's box touches in them
+     * @param changed The chunks the edit changed
+     * @param min The lowest corner of the edit's box
+     * @param max The highest corner of the edit's box, inclusive
+     */
+    void markEditedChunks(const std::vector<ChunkPosition>& changed, const VoxelPosition& min,
+                          const VoxelPosition& max);
+    
+    /**
+     * @brief Remesh the dirty chunks nearest the camera first within the remesh
+     * budget, handing the rest to the mesh workers
+     */
+    void remeshDirtyChunks();
+    
+    /**
+     * @brief Generate simple terrain for a chunk
+     * @param chunk Reference to the chunk to fill
+     * @param chunkPos Position of the chunk
+     */
+    void generateTerrain(Chunk& chunk, const ChunkPosition& chunkPos);
     
     ChunkPosition m_lastCameraChunk;
+    
+    // Chunks changed by setVoxel since the last update(), in the order they changed
+    std::vector<ChunkPosition> m_dirtyChunks;
+    ChunkPositionSet m_dirtyChunkSet;
+    float m_remeshTimeBudget;
+    
+    // Terrain generation and meshing jobs
+    // Declared last so the workers stop before anything their jobs read is destroyed
+    ThreadPool m_workers;
 };
@@ -12,6 +12,7 @@
 #include "voxel_world.h"
 
 #include <iostream>
+#include <memory>
 #include <sstream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -89,9 +90,10 @@ int main()
 
     Model stoneBlock("models/stone block/cube.obj");
     
-    // Initialize voxel world
-    VoxelWorld voxelWorld;
-    voxelWorld.initialize();
+    // Initialize voxel world, on the heap so it can be destroyed while the GL context
+    // still exists
+    auto voxelWorld = std::make_unique<VoxelWorld>();
+    voxelWorld->initialize();
     
 
     // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
@@ -154,6 +156,23 @@ int main()
     ourShader.setFloat("pointLights[3].linear", 0.09f);
     ourShader.setFloat("pointLights[3].quadratic", 0.032f);
 
+
+    // uniforms set every frame, resolved once so the render loop does no name lookups
+    ShaderUniform<glm::vec3> spotLightPosition = ourShader.getUniform<glm::vec3>("spotLight.position");
+    ShaderUniform<glm::vec3> spotLightDirection = ourShader.getUniform<glm::vec3>("spotLight.direction");
+    ShaderUniform<glm::mat4> projectionUniform = ourShader.getUniform<glm::mat4>("projection");
+    ShaderUniform<glm::mat4> viewUniform = ourShader.getUniform<glm::mat4>("view");
+    ShaderUniform<glm::mat4> modelUniform = ourShader.getUniform<glm::mat4>("model");
+
+    // the rest of the spotlight never changes
+    ourShader.setVec3("spotLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
+    ourShader.setVec3("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
+    ourShader.setVec3("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
+    ourShader.setFloat("spotLight.constant", 1.0f);
+    ourShader.setFloat("spotLight.linear", 0.09f);
+    ourShader.setFloat("spotLight.quadratic", 0.032f);
+    ourShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
+    ourShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
     
     // render loop
     // -----------
@@ -175,7 +194,7 @@ int main()
         processInput(window);
 
         // Update voxel world based on camera position
-        voxelWorld.update(camera.Position);
+        voxelWorld->update(camera.Position);
 
         // render
         // ------
@@ -186,44 +205,35 @@ int main()
         ourShader.use();
 
         // spotLight (update every frame to follow camera)
-        ourShader.setVec3("spotLight.position", camera.Position);
-        ourShader.setVec3("spotLight.direction", camera.Front);
-        ourShader.setVec3("spotLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
-        ourShader.setVec3("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
-        ourShader.setVec3("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-        ourShader.setFloat("spotLight.constant", 1.0f);
-        ourShader.setFloat("spotLight.linear", 0.09f);
-        ourShader.setFloat("spotLight.quadratic", 0.032f);
-        ourShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        ourShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
-        ourShader.use();
+        ourShader.set(spotLightPosition, camera.Position);
+        ourShader.set(spotLightDirection, camera.Front);
 
         // view/projection transformations
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
+        ourShader.set(projectionUniform, projection);
+        ourShader.set(viewUniform, view);
 
         // Render voxel world
-        voxelWorld.render(ourShader, view, projection);
+        voxelWorld->render(ourShader, view, projection);
 
         // render the loaded models (individual blocks for comparison)
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(50.0f, 10.0f, 50.0f)); // Move far from world center
         model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        ourShader.setMat4("model", model);
+        ourShader.set(modelUniform, model);
         ourModel.Draw(ourShader);
 
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(55.0f, 10.0f, 50.0f));
         model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        ourShader.setMat4("model", model);
+        ourShader.set(modelUniform, model);
          grassBlock.Draw(ourShader);
 
         model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(52.5f, 10.0f, 47.5f));
         model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        ourShader.setMat4("model", model);
+        ourShader.set(modelUniform, model);
         stoneBlock.Draw(ourShader);
 
 
@@ -233,6 +243,9 @@ int main()
         glfwPollEvents();
     }
 
+    // save the world and free its buffers and textures before the context goes away
+    voxelWorld.reset();
+
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
@@ -0,0 +1,204 @@
+#include "batch_noise.h"
+
+#include <glm/gtc/noise.hpp>
+
+#if defined(__AVX2__)
+#define BATCH_NOISE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCH_NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#if defined(BATCH_NOISE_AVX2)
+    struct Lanes {
+        using V = __m256;
+        static constexpr int WIDTH = 8;
+
+        static V set(float f) { return _mm256_set1_ps(f); }
+        static V load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+        static V add(V a, V b) { return _mm256_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+        static V div(V a, V b) { return _mm256_div_ps(a, b); }
+        static V min(V a, V b) { return _mm256_min_ps(a, b); }
+        static V max(V a, V b) { return _mm256_max_ps(a, b); }
+        static V floor(V a) { return _mm256_floor_ps(a); }
+        static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+        // glm::step(edge, x): 1 where x >= edge, otherwise 0
+        static V step(V edge, V x)
+        {
+            return _mm256_and_ps(_mm256_cmp_ps(x, edge, _CMP_GE_OQ), _mm256_set1_ps(1.0f));
+        }
+    };
+#elif defined(BATCH_NOISE_SSE2)
+    struct Lanes {
+        using V = __m128;
+        static constexpr int WIDTH = 4;
+
+        static V set(float f) { return _mm_set1_ps(f); }
+        static V load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+        static V add(V a, V b) { return _mm_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+        static V div(V a, V b) { return _mm_div_ps(a, b); }
+        static V min(V a, V b) { return _mm_min_ps(a, b); }
+        static V max(V a, V b) { return _mm_max_ps(a, b); }
+        static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+        // SSE2 has no floor, so truncate and step down where that rounded up
+        static V floor(V a)
+        {
+            V truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+            V roundedUp = _mm_cmpgt_ps(truncated, a);
+            return _mm_sub_ps(truncated, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+        }
+
+        // glm::step(edge, x): 1 where x >= edge, otherwise 0
+        static V step(V edge, V x)
+        {
+            return _mm_and_ps(_mm_cmpge_ps(x, edge), _mm_set1_ps(1.0f));
+        }
+    };
+#endif
+
+#if defined(BATCH_NOISE_AVX2) || defined(BATCH_NOISE_SSE2)
+    using V = Lanes::V;
+    using L = Lanes;
+
+    V mod289(V x)
+    {
+        return L::sub(x, L::mul(L::floor(L::div(x, L::set(289.0f))), L::set(289.0f)));
+    }
+
+    V permute(V x)
+    {
+        return mod289(L::mul(L::add(L::mul(x, L::set(34.0f)), L::set(1.0f)), x));
+    }
+
+    V dot3(V ax, V ay, V az, V bx, V by, V bz)
+    {
+        return L::add(L::add(L::mul(ax, bx), L::mul(ay, by)), L::mul(az, bz));
+    }
+
+    /**
+     * @brief glm::simplex(vec3) for one lane per point, following it step by step
+     * Each of the 4 simplex corners is handled separately rather than as a vec4
+     */
+    V simplex(V vx, V vy, V vz)
+    {
+        const V cx = L::set(static_cast<float>(1.0 / 6.0));
+        const V cy = L::set(static_cast<float>(1.0 / 3.0));
+        const V one = L::set(1.0f);
+
+        // First corner
+        V skew = dot3(vx, vy, vz, cy, cy, cy);
+        V ix = L::floor(L::add(vx, skew));
+        V iy = L::floor(L::add(vy, skew));
+        V iz = L::floor(L::add(vz, skew));
+        V unskew = dot3(ix, iy, iz, cx, cx, cx);
+        V x0[3] = {L::add(L::sub(vx, ix), unskew), L::add(L::sub(vy, iy), unskew),
+                   L::add(L::sub(vz, iz), unskew)};
+
+        // Other corners
+        V g[3] = {L::step(x0[1], x0[0]), L::step(x0[2], x0[1]), L::step(x0[0], x0[2])};
+        V l[3] = {L::sub(one, g[0]), L::sub(one, g[1]), L::sub(one, g[2])};
+        V i1[3] = {L::min(g[0], l[2]), L::min(g[1], l[0]), L::min(g[2], l[1])};
+        V i2[3] = {L::max(g[0], l[2]), L::max(g[1], l[0]), L::max(g[2], l[1])};
+
+        V corners[4][3];
+        V offsets[4][3];
+        for (int a = 0; a < 3; a++) {
+            corners[0][a] = x0[a];
+            corners[1][a] = L::add(L::sub(x0[a], i1[a]), cx);
+            corners[2][a] = L::add(L::sub(x0[a], i2[a]), cy);
+            corners[3][a] = L::sub(x0[a], L::set(0.5f));
+            offsets[0][a] = L::set(0.0f);
+            offsets[1][a] = i1[a];
+            offsets[2][a] = i2[a];
+            offsets[3][a] = one;
+        }
+
+        // Permutations
+        ix = mod289(ix);
+        iy = mod289(iy);
+        iz = mod289(iz);
+
+        // Gradients: 7x7 points over a square, mapped onto an octahedron
+        const float n = 0.142857142857f;
+        const V nsx = L::set(n * 2.0f);
+        const V nsy = L::set(n * 0.5f - 1.0f);
+        const V nsz = L::set(n);
+
+        V total = L::set(0.0f);
+        for (int c = 0; c < 4; c++) {
+            V p = permute(L::add(iz, offsets[c][2]));
+            p = permute(L::add(L::add(p, iy), offsets[c][1]));
+            p = permute(L::add(L::add(p, ix), offsets[c][0]));
+
+            V j = L::sub(p, L::mul(L::set(49.0f), L::floor(L::mul(L::mul(p, nsz), nsz))));
+            V xf = L::floor(L::mul(j, nsz));
+            V yf = L::floor(L::sub(j, L::mul(L::set(7.0f), xf)));
+
+            V x = L::add(L::mul(xf, nsx), nsy);
+            V y = L::add(L::mul(yf, nsx), nsy);
+            V h = L::sub(L::sub(one, L::abs(x)), L::abs(y));
+
+            V sx = L::add(L::mul(L::floor(x), L::set(2.0f)), one);
+            V sy = L::add(L::mul(L::floor(y), L::set(2.0f)), one);
+            V sh = L::sub(L::set(0.0f), L::step(h, L::set(0.0f)));
+
+            V gx = L::add(x, L::mul(sx, sh));
+            V gy = L::add(y, L::mul(sy, sh));
+            V gz = h;
+
+            // Normalise gradients
+            V norm = L::sub(L::set(1.79284291400159f),
+                            L::mul(L::set(0.85373472095314f), dot3(gx, gy, gz, gx, gy, gz)));
+            gx = L::mul(gx, norm);
+            gy = L::mul(gy, norm);
+            gz = L::mul(gz, norm);
+
+            // Mix final noise value
+            const V* xc = corners[c];
+            V m = L::max(L::sub(L::set(0.6f), dot3(xc[0], xc[1], xc[2], xc[0], xc[1], xc[2])),
+                         L::set(0.0f));
+            m = L::mul(m, m);
+            total = L::add(total, L::mul(L::mul(m, m), dot3(gx, gy, gz, xc[0], xc[1], xc[2])));
+        }
+        return L::mul(L::set(42.0f), total);
+    }
+#endif
+
+} // namespace
+
+void simplexNoiseBatch(const float* xs, const float* ys, float z, float* out, int count)
+{
+    int i = 0;
+#if defined(BATCH_NOISE_AVX2) || defined(BATCH_NOISE_SSE2)
+    const V vz = L::set(z);
+    for (; i + L::WIDTH <= count; i += L::WIDTH) {
+        L::store(out + i, simplex(L::load(xs + i), L::load(ys + i), vz));
+    }
+#endif
+    // Scalar fallback, and whatever is left over after the full vectors
+    for (; i < count; i++) {
+        out[i] = glm::simplex(glm::vec3{xs[i], ys[i], z});
+    }
+}
+
+const char* batchNoiseInstructionSet()
+{
+#if defined(BATCH_NOISE_AVX2)
+    return "AVX2";
+#elif defined(BATCH_NOISE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * @brief Evaluate 3D simplex noise for many points that share a Z coordinate
+ * Same algorithm as glm::simplex, vectorised with AVX2 or SSE2 when the build
+ * targets them and falling back to glm::simplex otherwise. Results match
+ * glm::simplex to within float rounding.
+ *
+ * @param xs X coordinate of each point
+ * @param ys Y coordinate of each point
+ * @param z Z coordinate of every point
+ * @param out Noise value of each point, in the range -1 to 1
+ * @param count Number of points
+ */
+void simplexNoiseBatch(const float* xs, const float* ys, float z, float* out, int count);
+
+/**
+ * @brief Name of the instruction set simplexNoiseBatch was built with
+ *
+ * @return const char* "AVX2", "SSE2" or "scalar"
+ */
+const char* batchNoiseInstructionSet();
@@ -21,13 +21,13 @@ Chunk::Chunk(ChunkManager& manager, const ChunkPosition& position)
 voxel_t Chunk::qGetVoxel(const VoxelPosition& voxelPosition) const
 {
     assert(!voxelPositionOutOfChunkBounds(voxelPosition));
-    return voxels[toLocalVoxelIndex(voxelPosition)];
+    return m_voxels.get(toLocalVoxelIndex(voxelPosition));
 }
 
 void Chunk::qSetVoxel(const VoxelPosition& voxelPosition, voxel_t voxel)
 {
     assert(!voxelPositionOutOfChunkBounds(voxelPosition));
-    voxels[toLocalVoxelIndex(voxelPosition)] = voxel;
+    m_voxels.set(toLocalVoxelIndex(voxelPosition), voxel);
 }
 
 voxel_t Chunk::getVoxel(const VoxelPosition& voxelPosition) const
@@ -52,6 +52,26 @@ const ChunkPosition& Chunk::getPosition() const
     return m_position;
 }
 
+void Chunk::setVoxels(const VoxelArray& voxels)
+{
+    m_voxels.assign(voxels);
+}
+
+void Chunk::copyVoxels(VoxelArray& voxels) const
+{
+    m_voxels.copyTo(voxels);
+}
+
+bool Chunk::isUniform() const
+{
+    return m_voxels.isUniform();
+}
+
+std::size_t Chunk::memoryUsage() const
+{
+    return sizeof(Chunk) - sizeof(PalettedVoxels) + m_voxels.memoryUsage();
+}
+
 CompressedVoxels compressVoxelData(const VoxelArray& voxels)
 {
     CompressedVoxels compressed;
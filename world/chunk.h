@@ -2,14 +2,13 @@
 
 #include "../types.h"
 #include "coordinate.h"
+#include "paletted_voxels.h"
 #include "world_constants.h"
 #include <array>
 #include <vector>
 
 class ChunkManager;
 
-using VoxelArray = std::array<voxel_t, CHUNK_VOLUME>;
-
 /**
  * @brief Compressed chunk voxel data
  * Contains a voxel, followed by how many voxels are exactly the same after
@@ -70,11 +69,38 @@ class Chunk {
 
     const ChunkPosition& getPosition() const;
 
-    VoxelArray voxels{0};
+    /**
+     * @brief Replace every voxel of the chunk
+     *
+     * @param voxels The new voxels
+     */
+    void setVoxels(const VoxelArray& voxels);
+
+    /**
+     * @brief Copy every voxel of the chunk out
+     *
+     * @param voxels Array to write the voxels to
+     */
+    void copyVoxels(VoxelArray& voxels) const;
+
+    /**
+     * @brief Check if every voxel in the chunk is the same
+     *
+     * @return true The chunk is a single voxel type
+     */
+    bool isUniform() const;
+
+    /**
+     * @brief Memory used by the chunk and its voxels
+     *
+     * @return std::size_t Size in bytes
+     */
+    std::size_t memoryUsage() const;
 
   private:
     ChunkManager& mp_manager;
     ChunkPosition m_position;
+    PalettedVoxels m_voxels;
 };
 
 /**
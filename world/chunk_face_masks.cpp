@@ -0,0 +1,97 @@
+#include "chunk_face_masks.h"
+
+#include "voxel_data.h"
+
+namespace {
+    constexpr int LAST = CHUNK_SIZE - 1;
+
+    bool isSolid(voxel_t voxel)
+    {
+        return voxel != 0;
+    }
+
+    void buildOccupancy(const PaddedVoxelArray& voxels, const VoxelDataManager& voxelData,
+                        ChunkRowMasks& solid, ChunkRowMasks& cubes)
+    {
+        std::array<u32, 256> isCube{};
+        for (const VoxelData& data : voxelData.getVoxelData()) {
+            isCube[data.id] = data.meshStyle == VoxelMeshStyle::Voxel;
+        }
+
+        solid.fill(0);
+        cubes.fill(0);
+        // Walk the chunk's voxels in memory order, scattering each voxel into its row
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                const voxel_t* voxel = &voxels[toPaddedVoxelIndex({0, y, z})];
+                for (int x = 0; x < CHUNK_SIZE; x++) {
+                    const int row = toRowMaskIndex(x, y);
+                    solid[row] |= static_cast<u32>(isSolid(voxel[x])) << z;
+                    cubes[row] |= isCube[voxel[x]] << z;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Occupancy of the border the padding holds on one side of the chunk
+     * For the X and Y sides each entry is a row along Z, for the Z sides each entry
+     * holds one bit per Y instead
+     */
+    using BorderMasks = std::array<u32, CHUNK_SIZE>;
+
+    BorderMasks buildBorder(const PaddedVoxelArray& voxels, int direction)
+    {
+        BorderMasks border{};
+        for (int a = 0; a < CHUNK_SIZE; a++) {
+            for (int b = 0; b < CHUNK_SIZE; b++) {
+                VoxelPosition position;
+                switch (direction) {
+                    // clang-format off
+                    case 0: position = {-1, a, b}; break;
+                    case 1: position = {CHUNK_SIZE, a, b}; break;
+                    case 2: position = {a, -1, b}; break;
+                    case 3: position = {a, CHUNK_SIZE, b}; break;
+                    case 4: position = {a, b, -1}; break;
+                    default: position = {a, b, CHUNK_SIZE}; break;
+                    // clang-format on
+                }
+                border[a] |= static_cast<u32>(isSolid(voxels[toPaddedVoxelIndex(position)])) << b;
+            }
+        }
+        return border;
+    }
+} // namespace
+
+void buildChunkFaceMasks(const VoxelDataManager& voxelData, const PaddedVoxelArray& voxels,
+                         ChunkFaceMasks& masks)
+{
+    const ChunkRowMasks& solid = masks.solid;
+    buildOccupancy(voxels, voxelData, masks.solid, masks.cubes);
+
+    BorderMasks borders[6];
+    for (int direction = 0; direction < 6; direction++) {
+        borders[direction] = buildBorder(voxels, direction);
+    }
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            const int row = toRowMaskIndex(x, y);
+            const u32 current = solid[row];
+
+            const u32 left = x > 0 ? solid[toRowMaskIndex(x - 1, y)] : borders[0][y];
+            const u32 right = x < LAST ? solid[toRowMaskIndex(x + 1, y)] : borders[1][y];
+            const u32 bottom = y > 0 ? solid[toRowMaskIndex(x, y - 1)] : borders[2][x];
+            const u32 top = y < LAST ? solid[toRowMaskIndex(x, y + 1)] : borders[3][x];
+            const u32 back = (current << 1) | ((borders[4][x] >> y) & 1u);
+            const u32 front = (current >> 1) | (((borders[5][x] >> y) & 1u) << LAST);
+
+            masks.faces[0][row] = current & ~left;
+            masks.faces[1][row] = current & ~right;
+            masks.faces[2][row] = current & ~bottom;
+            masks.faces[3][row] = current & ~top;
+            masks.faces[4][row] = current & ~back;
+            masks.faces[5][row] = current & ~front;
+        }
+    }
+}
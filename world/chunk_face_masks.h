@@ -0,0 +1,90 @@
+#pragma once
+
+#include "chunk.h"
+#include "padded_voxels.h"
+#include <array>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+class VoxelDataManager;
+
+/**
+ * @brief One bit per voxel of a chunk, stored as rows along the Z axis
+ * Row (x, y) is at index x * CHUNK_SIZE + y, and bit z of it is the voxel at (x, y, z)
+ */
+using ChunkRowMasks = std::array<u32, CHUNK_AREA>;
+
+/**
+ * @brief Visible faces of every voxel in a chunk
+ * A face bit is set when the voxel is not air and the voxel next to it in that
+ * direction is air, which the padding holds for chunks that are not loaded
+ */
+struct ChunkFaceMasks {
+    // Indexed by direction: 0=left(-X), 1=right(+X), 2=bottom(-Y), 3=top(+Y), 4=back(-Z), 5=front(+Z)
+    std::array<ChunkRowMasks, 6> faces;
+
+    // Every voxel that is not air
+    ChunkRowMasks solid;
+
+    // Voxels meshed with VoxelMeshStyle::Voxel
+    ChunkRowMasks cubes;
+};
+
+/**
+ * @brief Get the row mask index of a local voxel position
+ *
+ * @param x Local X position
+ * @param y Local Y position
+ * @return int The index of the row holding every Z of (x, y)
+ */
+inline int toRowMaskIndex(int x, int y)
+{
+    return x * CHUNK_SIZE + y;
+}
+
+/**
+ * @brief Get the index of the lowest set bit
+ *
+ * @param bits The bits to search, must not be 0
+ * @return int The index of the lowest set bit
+ */
+inline int lowestSetBit(u32 bits)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+/**
+ * @brief Count the set bits
+ *
+ * @param bits The bits to count
+ * @return int The number of set bits
+ */
+inline int countSetBits(u32 bits)
+{
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt(bits));
+#else
+    return __builtin_popcount(bits);
+#endif
+}
+
+/**
+ * @brief Build the visible face masks of a chunk
+ * Occupancy is gathered into one 32-bit row per (x, y), then the faces of all
+ * 32 voxels in a row are found at once with shifts and ANDs against the
+ * neighbouring rows, and against the padding on the chunk's sides
+ *
+ * @param voxelData Voxel data used to find which voxels are meshed as cubes
+ * @param voxels The chunk and the voxels of its neighbours that touch it
+ * @param masks The masks to fill in
+ */
+void buildChunkFaceMasks(const VoxelDataManager& voxelData, const PaddedVoxelArray& voxels,
+                         ChunkFaceMasks& masks);
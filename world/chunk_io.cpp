@@ -0,0 +1,193 @@
+#include "chunk_io.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    // Finished loads waiting for the render thread, the I/O thread waits when full
+    constexpr std::size_t COMPLETED_CAPACITY = 1024;
+
+    int distanceSquared(const ChunkPosition& a, const ChunkPosition& b)
+    {
+        int dx = a.x - b.x;
+        int dz = a.z - b.z;
+        return dx * dx + dz * dz;
+    }
+
+    // Heap order that puts the load nearest to the focus on top
+    struct FartherFromFocus {
+        ChunkPosition focus;
+
+        template <typename Load>
+        bool operator()(const Load& a, const Load& b) const
+        {
+            return distanceSquared(a.column, focus) > distanceSquared(b.column, focus);
+        }
+    };
+} // namespace
+
+ChunkIO::ChunkIO(RegionStorage& storage)
+    : m_storage(storage)
+    , m_completed(COMPLETED_CAPACITY)
+    , m_thread(&ChunkIO::ioLoop, this)
+{
+}
+
+ChunkIO::~ChunkIO()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_loads.clear();
+        m_prefetches.clear();
+    }
+    m_workAvailable.notify_all();
+    m_thread.join();
+}
+
+u64 ChunkIO::requestLoad(const ChunkPosition& column)
+{
+    u64 id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = ++m_nextRequest;
+        m_loads.push_back({id, column});
+        std::push_heap(m_loads.begin(), m_loads.end(), FartherFromFocus{m_focus});
+    }
+    m_workAvailable.notify_one();
+    return id;
+}
+
+void ChunkIO::requestSave(StoredColumn column)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_saves.push_back(std::move(column));
+    }
+    m_workAvailable.notify_one();
+}
+
+void ChunkIO::requestPrefetch(std::vector<ChunkPosition> columns)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_prefetches = std::move(columns);
+    }
+    m_workAvailable.notify_one();
+}
+
+void ChunkIO::cancelLoad(u64 request)
+{
+    // Removed from the heap when it reaches the top
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cancelledLoads.insert(request);
+}
+
+void ChunkIO::setFocus(const ChunkPosition& column)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (column.x == m_focus.x && column.z == m_focus.z) {
+        return;
+    }
+    m_focus = column;
+    rebuildLoadHeap();
+}
+
+void ChunkIO::rebuildLoadHeap()
+{
+    // Drop cancelled loads while every request is being looked at anyway
+    if (!m_cancelledLoads.empty()) {
+        m_loads.erase(std::remove_if(m_loads.begin(), m_loads.end(),
+                                     [this](const LoadRequest& load) {
+                                         return m_cancelledLoads.count(load.id) > 0;
+                                     }),
+                      m_loads.end());
+        m_cancelledLoads.clear();
+    }
+    std::make_heap(m_loads.begin(), m_loads.end(), FartherFromFocus{m_focus});
+}
+
+bool ChunkIO::popCompleted(LoadResult& result)
+{
+    return m_completed.tryPop(result);
+}
+
+void ChunkIO::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_savesWritten.wait(lock, [this] { return m_saves.empty() && m_savesInProgress == 0; });
+}
+
+void ChunkIO::ioLoop()
+{
+    // A load the render thread had no room for yet, no more loads start until it fits
+    LoadResult unpushed;
+    bool hasUnpushed = false;
+
+    while (true) {
+        if (hasUnpushed && m_completed.tryPush(unpushed)) {
+            hasUnpushed = false;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto hasWork = [this, &hasUnpushed] {
+            return m_stopping || !m_saves.empty() ||
+                   (!hasUnpushed && (!m_loads.empty() || !m_prefetches.empty()));
+        };
+        if (hasUnpushed) {
+            // The render thread doesn't signal when it pops, so check again soon
+            m_workAvailable.wait_for(lock, std::chrono::milliseconds(1), hasWork);
+        }
+        else {
+            m_workAvailable.wait(lock, hasWork);
+        }
+
+        // Saves first, so loads queued after a save read what it wrote
+        if (!m_saves.empty()) {
+            StoredColumn column = std::move(m_saves.front());
+            m_saves.pop_front();
+            m_savesInProgress++;
+            lock.unlock();
+
+            m_storage.saveColumn(column);
+
+            lock.lock();
+            m_savesInProgress--;
+            if (m_saves.empty() && m_savesInProgress == 0) {
+                m_savesWritten.notify_all();
+            }
+            continue;
+        }
+        if (m_stopping) {
+            return;
+        }
+        if (hasUnpushed) {
+            continue;
+        }
+
+        if (!m_loads.empty()) {
+            std::pop_heap(m_loads.begin(), m_loads.end(), FartherFromFocus{m_focus});
+            LoadRequest load = m_loads.back();
+            m_loads.pop_back();
+            if (m_cancelledLoads.erase(load.id) > 0) {
+                continue;
+            }
+            lock.unlock();
+
+            LoadResult result;
+            result.request = load.id;
+            result.column = load.column;
+            result.found = m_storage.loadColumn(load.column.x, load.column.z, result.data);
+            if (!m_completed.tryPush(result)) {
+                unpushed = std::move(result);
+                hasUnpushed = true;
+            }
+            continue;
+        }
+
+        std::vector<ChunkPosition> prefetches = std::move(m_prefetches);
+        m_prefetches.clear();
+        lock.unlock();
+        m_storage.prefetchColumns(prefetches);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../types.h"
+#include "coordinate.h"
+#include "region_file.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Runs region file loads and saves on a thread of its own
+ *
+ * Saves are written before any load, so loading a column always sees what was
+ * queued to be saved for it before. Loads are taken nearest to the focus column
+ * first, and finished loads are handed back through a lock-free queue that one
+ * thread, the render thread, drains.
+ */
+class ChunkIO final {
+  public:
+    struct LoadResult {
+        u64 request = 0;
+        ChunkPosition column;
+        // False if the column was never stored and has to be generated
+        bool found = false;
+        LoadedColumn data;
+    };
+
+    /**
+     * @brief Start the I/O thread
+     *
+     * @param storage Region files to load from and save to, must outlive this
+     */
+    explicit ChunkIO(RegionStorage& storage);
+
+    /**
+     * @brief Write the queued saves, drop the queued loads, then stop the thread
+     */
+    ~ChunkIO();
+
+    ChunkIO(const ChunkIO&) = delete;
+    ChunkIO& operator=(const ChunkIO&) = delete;
+
+    /**
+     * @brief Queue loading a column
+     *
+     * @param column Position of the column, with y = 0
+     * @return u64 Id of the request, on its result and for cancelLoad
+     */
+    u64 requestLoad(const ChunkPosition& column);
+
+    /**
+     * @brief Queue saving a column
+     *
+     * @param column The column to save
+     */
+    void requestSave(StoredColumn column);
+
+    /**
+     * @brief Queue read-ahead hints for columns, done when nothing else is queued
+     * Replaces the hints that were not done yet
+     *
+     * @param columns Positions of the columns, y is ignored
+     */
+    void requestPrefetch(std::vector<ChunkPosition> columns);
+
+    /**
+     * @brief Drop a load that has not started, one that has still gives a result
+     *
+     * @param request Id from requestLoad
+     */
+    void cancelLoad(u64 request);
+
+    /**
+     * @brief Set the column queued loads are prioritized by
+     *
+     * @param column The camera's column, y is ignored
+     */
+    void setFocus(const ChunkPosition& column);
+
+    /**
+     * @brief Take a finished load, only called from one thread
+     *
+     * @param result Set to the result if there was one
+     * @return true A result was taken
+     */
+    bool popCompleted(LoadResult& result);
+
+    /**
+     * @brief Wait until every queued save is written
+     */
+    void flush();
+
+  private:
+    struct LoadRequest {
+        u64 id;
+        ChunkPosition column;
+    };
+
+    void ioLoop();
+    void rebuildLoadHeap();
+
+    RegionStorage& m_storage;
+
+    // Min-heap of loads by distance to m_focus
+    std::vector<LoadRequest> m_loads;
+    std::unordered_set<u64> m_cancelledLoads;
+    std::deque<StoredColumn> m_saves;
+    std::vector<ChunkPosition> m_prefetches;
+    ChunkPosition m_focus{0, 0, 0};
+    u64 m_nextRequest = 0;
+    u32 m_savesInProgress = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_savesWritten;
+    std::atomic<bool> m_stopping{false};
+
+    SpscQueue<LoadResult> m_completed;
+
+    // Started last, everything above is ready before it runs
+    std::thread m_thread;
+};
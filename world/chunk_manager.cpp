@@ -4,53 +4,54 @@
 
 Chunk& ChunkManager::addChunk(const ChunkPosition& chunk)
 {
-    auto itr = m_chunks.find(chunk);
-    if (itr == m_chunks.cend()) {
-        return m_chunks
-            .emplace(std::piecewise_construct, std::forward_as_tuple(chunk),
-                     std::forward_as_tuple(*this, chunk))
-            .first->second;
-    }
-    return itr->second;
+    return *m_chunks.tryEmplace(chunk, *this, chunk).first;
 }
 
 const Chunk& ChunkManager::getChunk(const ChunkPosition& chunk)
 {
-    auto itr = m_chunks.find(chunk);
-    if (itr == m_chunks.cend()) {
+    const Chunk* found = m_chunks.find(chunk);
+    if (!found) {
         static Chunk errorChunk(*this, {0, 0, 0});
         return errorChunk;
     }
-    return itr->second;
+    return *found;
+}
+
+const Chunk* ChunkManager::findChunk(const ChunkPosition& chunk) const
+{
+    return m_chunks.find(chunk);
+}
+
+Chunk* ChunkManager::findChunk(const ChunkPosition& chunk)
+{
+    return m_chunks.find(chunk);
+}
+
+bool ChunkManager::removeChunk(const ChunkPosition& chunk)
+{
+    return m_chunks.erase(chunk);
 }
 
 voxel_t ChunkManager::getVoxel(const VoxelPosition& voxelPosition) const
 {
-    auto chunkPosition = toChunkPosition(voxelPosition);
-    auto itr = m_chunks.find(chunkPosition);
-    if (itr == m_chunks.cend()) {
+    const Chunk* chunk = m_chunks.find(toChunkPosition(voxelPosition));
+    if (!chunk) {
         return 0;
     }
-    return itr->second.qGetVoxel(toLocalVoxelPosition(voxelPosition));
+    return chunk->qGetVoxel(toLocalVoxelPosition(voxelPosition));
 }
 
 void ChunkManager::setVoxel(const VoxelPosition& voxelPosition, voxel_t voxel)
 {
     auto chunkPosition = toChunkPosition(voxelPosition);
-    auto itr = m_chunks.find(chunkPosition);
     auto local = toLocalVoxelPosition(voxelPosition);
-    if (itr != m_chunks.cend()) {
-        itr->second.qSetVoxel(local, voxel);
-    }
-    else {
-        addChunk(chunkPosition).qSetVoxel(local, voxel);
-    }
+    addChunk(chunkPosition).qSetVoxel(local, voxel);
     ensureNeighbours(chunkPosition);
 }
 
 bool ChunkManager::hasChunk(const ChunkPosition& chunk) const
 {
-    return m_chunks.find(chunk) != m_chunks.cend();
+    return m_chunks.contains(chunk);
 }
 
 bool ChunkManager::hasNeighbours(const ChunkPosition& chunkPosition) const
@@ -83,7 +84,16 @@ void ChunkManager::ensureNeighbours(const ChunkPosition& chunkPosition)
     addChunk({cp.x, cp.y, cp.z + 1});
 }
 
-const ChunkPositionMap<Chunk>& ChunkManager::chunks() const
+const FlatChunkMap<Chunk>& ChunkManager::chunks() const
 {
     return m_chunks;
 }
+
+std::size_t ChunkManager::memoryUsage() const
+{
+    std::size_t bytes = 0;
+    for (const auto& slot : m_chunks) {
+        bytes += slot.value->memoryUsage();
+    }
+    return bytes;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "chunk.h"
+#include "flat_chunk_map.h"
 
 /**
  * @brief Basic chunk container
@@ -19,6 +20,24 @@ class ChunkManager final {
     const Chunk& getChunk(const ChunkPosition& chunk);
     const Chunk& getChunk(const ChunkPosition& chunk) const;
 
+    /**
+     * @brief Find the chunk at a position
+     *
+     * @param chunk The position to look for
+     * @return const Chunk* The chunk, or nullptr if there is no chunk there
+     */
+    const Chunk* findChunk(const ChunkPosition& chunk) const;
+    Chunk* findChunk(const ChunkPosition& chunk);
+
+    /**
+     * @brief Unload the chunk at a position
+     *
+     * @param chunk The position of the chunk to remove
+     * @return true A chunk was removed
+     * @return false There was no chunk at the position
+     */
+    bool removeChunk(const ChunkPosition& chunk);
+
     voxel_t getVoxel(const VoxelPosition& voxelPosition) const;
     void setVoxel(const VoxelPosition& voxelPosition, voxel_t voxel);
 
@@ -47,8 +66,15 @@ class ChunkManager final {
      */
     void ensureNeighbours(const ChunkPosition& chunkPosition);
 
-    const ChunkPositionMap<Chunk>& chunks() const;
+    const FlatChunkMap<Chunk>& chunks() const;
+
+    /**
+     * @brief Memory used by the voxels of every loaded chunk
+     *
+     * @return std::size_t Size in bytes
+     */
+    std::size_t memoryUsage() const;
 
   private:
-    ChunkPositionMap<Chunk> m_chunks;
+    FlatChunkMap<Chunk> m_chunks;
 };
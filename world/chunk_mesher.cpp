@@ -0,0 +1,496 @@
+#include "chunk_mesher.h"
+#include "chunk_manager.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+    /**
+     * @brief Vertex layout of one cube face, matching the quads written by createCubeMesh
+     * Corners are unit cube offsets from the voxel's minimum corner, and each texture
+     * coordinate follows one of the axes so that merged faces can tile their texture
+     */
+    struct CubeFace {
+        int axis;
+        int corners[4][3];
+        int uvs[4][2];
+        int uvAxes[2];
+    };
+
+    // Indexed by direction: 0=left(-X), 1=right(+X), 2=bottom(-Y), 3=top(+Y), 4=back(-Z), 5=front(+Z)
+    // clang-format off
+    constexpr CubeFace CUBE_FACES[6] = {
+        {0, {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}, {2, 1}},
+        {0, {{1, 0, 0}, {1, 0, 1}, {1, 1, 1}, {1, 1, 0}}, {{1, 0}, {0, 0}, {0, 1}, {1, 1}}, {2, 1}},
+        {1, {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, {{0, 1}, {1, 1}, {1, 0}, {0, 0}}, {0, 2}},
+        {1, {{0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1}}, {{0, 1}, {1, 1}, {1, 0}, {0, 0}}, {0, 2}},
+        {2, {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}}, {{1, 0}, {0, 0}, {0, 1}, {1, 1}}, {0, 1}},
+        {2, {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}}, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}, {0, 1}},
+    };
+    // clang-format on
+
+    // Two triangles per quad, wound like the corners above
+    constexpr unsigned int QUAD_INDICES[6] = {0, 1, 2, 2, 3, 0};
+
+    /**
+     * @brief Vertex layout of one of the two diagonal planes written by createCrossMesh
+     */
+    struct CrossPlane {
+        int direction;
+        int corners[4][3];
+        int uvs[4][2];
+    };
+
+    // clang-format off
+    constexpr CrossPlane CROSS_PLANES[2] = {
+        // From the (0, 0, 0) to the (1, 1, 1) corner, facing front (+Z)
+        {5, {{0, 0, 0}, {1, 0, 1}, {1, 1, 1}, {0, 1, 0}}, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}},
+        // From the (0, 0, 1) to the (1, 1, 0) corner, facing back (-Z)
+        {4, {{0, 0, 1}, {1, 0, 0}, {1, 1, 0}, {0, 1, 1}}, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}},
+    };
+    // clang-format on
+
+    // Both sides of a plane are drawn, the back with the winding reversed
+    constexpr unsigned int CROSS_PLANE_INDICES[12] = {0, 1, 2, 2, 3, 0, 2, 1, 0, 0, 3, 2};
+
+    // Most geometry a single voxel that is not a cube can add, two double sided planes
+    constexpr std::size_t CROSS_VERTICES = 8;
+    constexpr std::size_t CROSS_INDICES = 24;
+
+    /**
+     * @brief Block texture array layer of one face of a voxel
+     */
+    u32 faceTextureLayer(const VoxelData& voxelData, int direction)
+    {
+        switch (direction) {
+            case 2: return voxelData.bottomTextureLayer;
+            case 3: return voxelData.topTextureLayer;
+            default: return voxelData.sideTextureLayer;
+        }
+    }
+
+    /**
+     * @brief Writes a face quad covering size[0] x size[1] x size[2] voxels from origin
+     */
+    void emitFace(int direction, const int origin[3], const int size[3], u32 layer,
+                  std::vector<PackedVoxelVertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        const CubeFace& face = CUBE_FACES[direction];
+        unsigned int vertexOffset = static_cast<unsigned int>(vertices.size());
+        for (int i = 0; i < 4; i++) {
+            int corner[3];
+            for (int a = 0; a < 3; a++) {
+                corner[a] = origin[a] + face.corners[i][a] * size[a];
+            }
+            vertices.push_back(packVoxelVertex(corner[0], corner[1], corner[2], direction,
+                                               face.uvs[i][0] * size[face.uvAxes[0]],
+                                               face.uvs[i][1] * size[face.uvAxes[1]], layer));
+        }
+        for (unsigned int index : QUAD_INDICES) {
+            indices.push_back(index + vertexOffset);
+        }
+    }
+
+    /**
+     * @brief Position in a neighbour of the voxel next to a position on the chunk's side
+     * @param axis Axis the neighbour is along
+     * @param plane The neighbour's plane that touches the chunk, 0 or CHUNK_SIZE - 1
+     */
+    VoxelPosition borderPosition(int axis, int plane, int u, int v)
+    {
+        return axis == 0 ? VoxelPosition{plane, u, v}
+             : axis == 1 ? VoxelPosition{u, plane, v}
+                         : VoxelPosition{u, v, plane};
+    }
+    
+    /**
+     * @brief Copy the plane of a neighbour that touches the chunk into the chunk's padding
+     * @param neighbour The chunk next to the one being copied
+     * @param direction Direction of the neighbour from the chunk being copied
+     * @param voxels Padded voxels of the chunk being copied
+     */
+    void copyBorder(const Chunk& neighbour, int direction, PaddedVoxelArray& voxels)
+    {
+        const int axis = direction / 2;
+        const int plane = direction % 2 == 0 ? CHUNK_SIZE - 1 : 0;
+        const int padding = direction % 2 == 0 ? -1 : CHUNK_SIZE;
+        for (int u = 0; u < CHUNK_SIZE; u++) {
+            for (int v = 0; v < CHUNK_SIZE; v++) {
+                voxels[toPaddedVoxelIndex(borderPosition(axis, padding, u, v))] =
+                    neighbour.qGetVoxel(borderPosition(axis, plane, u, v));
+            }
+        }
+    }
+
+    /**
+     * @brief Check that no voxel of a neighbour is air where it touches the chunk
+     * @param neighbour The chunk next to the one being meshed
+     * @param direction Direction of the neighbour from the chunk being meshed
+     */
+    bool isBorderSolid(const Chunk& neighbour, int direction)
+    {
+        const voxel_t air = static_cast<voxel_t>(CommonVoxel::Air);
+        if (neighbour.isUniform()) {
+            return neighbour.qGetVoxel({0, 0, 0}) != air;
+        }
+
+        // The plane on the neighbour's far side from its own point of view
+        const int axis = direction / 2;
+        const int plane = direction % 2 == 0 ? CHUNK_SIZE - 1 : 0;
+        for (int u = 0; u < CHUNK_SIZE; u++) {
+            for (int v = 0; v < CHUNK_SIZE; v++) {
+                if (neighbour.qGetVoxel(borderPosition(axis, plane, u, v)) == air) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+} // namespace
+
+bool fillChunkMeshSnapshot(const ChunkManager& chunkManager, const ChunkPosition& chunkPos,
+                           ChunkMeshSnapshot& snapshot) {
+    const Chunk* chunk = chunkManager.findChunk(chunkPos);
+    if (!chunk) return false;
+    
+    snapshot.position = chunkPos;
+    snapshot.voxels.fill(static_cast<voxel_t>(CommonVoxel::Air));
+    
+    // The chunk itself, one row along X at a time
+    VoxelArray voxels;
+    chunk->copyVoxels(voxels);
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            std::copy_n(&voxels[toLocalVoxelIndex({0, y, z})], CHUNK_SIZE,
+                        &snapshot.voxels[toPaddedVoxelIndex({0, y, z})]);
+        }
+    }
+    
+    // Only the plane of each neighbour that touches the chunk
+    for (int direction = 0; direction < 6; direction++) {
+        const Chunk* neighbour = chunkManager.findChunk(neighbourChunkPosition(chunkPos, direction));
+        if (neighbour) {
+            copyBorder(*neighbour, direction, snapshot.voxels);
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<ChunkMeshSnapshot> createChunkMeshSnapshot(const ChunkManager& chunkManager,
+                                                           const ChunkPosition& chunkPos) {
+    auto snapshot = std::make_unique<ChunkMeshSnapshot>();
+    if (!fillChunkMeshSnapshot(chunkManager, chunkPos, *snapshot)) return nullptr;
+    return snapshot;
+}
+
+ChunkMeshData buildChunkMesh(const ChunkMeshSnapshot& snapshot, const VoxelDataManager& voxelDataManager,
+                             const BlockModelMap& blockModels, VoxelMeshingMode meshingMode,
+                             FaceCullingMode faceCullingMode) {
+    ChunkMeshData data;
+    ChunkMesher mesher(voxelDataManager, blockModels, meshingMode, faceCullingMode);
+    mesher.build(snapshot, data);
+    return data;
+}
+
+bool isChunkMeshEmpty(const ChunkManager& chunkManager, const VoxelDataManager& voxelDataManager,
+                      const ChunkPosition& chunkPos) {
+    const Chunk* chunk = chunkManager.findChunk(chunkPos);
+    if (!chunk || !chunk->isUniform()) return false;
+
+    voxel_t voxel = chunk->qGetVoxel({0, 0, 0});
+    if (voxel == static_cast<voxel_t>(CommonVoxel::Air)) return true;
+
+    VoxelMeshStyle meshStyle = voxelDataManager.getVoxelData(voxel).meshStyle;
+    if (meshStyle == VoxelMeshStyle::None) return true;
+
+    // Crosses and models are meshed whatever surrounds them
+    if (meshStyle != VoxelMeshStyle::Voxel) return false;
+
+    // Faces next to a chunk that is not loaded are drawn
+    for (int direction = 0; direction < 6; direction++) {
+        const Chunk* neighbour = chunkManager.findChunk(neighbourChunkPosition(chunkPos, direction));
+        if (!neighbour || !isBorderSolid(*neighbour, direction)) return false;
+    }
+    return true;
+}
+
+ChunkMesher::ChunkMesher(const VoxelDataManager& voxelDataManager, const BlockModelMap& blockModels,
+                         VoxelMeshingMode meshingMode, FaceCullingMode faceCullingMode)
+    : m_voxelDataManager(voxelDataManager), m_blockModels(blockModels),
+      m_meshingMode(meshingMode), m_faceCullingMode(faceCullingMode), m_snapshot(nullptr) {
+}
+
+void ChunkMesher::build(const ChunkMeshSnapshot& snapshot, ChunkMeshData& buffers) {
+    m_snapshot = &snapshot;
+    
+    // Cleared rather than freed, so reused buffers keep their capacity
+    buffers.vertices.clear();
+    buffers.indices.clear();
+    buffers.modelVertices.clear();
+    buffers.modelIndices.clear();
+    
+    if (m_faceCullingMode == FaceCullingMode::Bitmask) {
+        buildChunkFaceMasks(m_voxelDataManager, snapshot.voxels, m_faceMasks);
+        reserveGeometry(buffers);
+    }
+    
+    // Solid blocks are emitted in one pass for the whole chunk when merging faces
+    if (m_meshingMode == VoxelMeshingMode::Greedy) {
+        createGreedyMesh(buffers);
+    }
+    
+    // Generate mesh for each voxel in the chunk
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            if (m_faceCullingMode == FaceCullingMode::Bitmask) {
+                // Only voxels with a visible face, or that are not meshed as cubes, add geometry.
+                // Visiting them in increasing Z keeps the output identical to the per-voxel path
+                const int row = toRowMaskIndex(x, y);
+                u32 candidates = m_faceMasks.solid[row] & ~m_faceMasks.cubes[row];
+                for (const ChunkRowMasks& faces : m_faceMasks.faces) {
+                    candidates |= faces[row];
+                }
+                while (candidates) {
+                    VoxelPosition localPos = {x, y, lowestSetBit(candidates)};
+                    candidates &= candidates - 1;
+                    
+                    voxel_t voxel = voxelAt(localPos);
+                    const VoxelData& voxelData = m_voxelDataManager.getVoxelData(voxel);
+                    if (voxelData.meshStyle == VoxelMeshStyle::None) continue;
+                    
+                    createVoxelMesh(localPos, voxel, voxelData, buffers);
+                }
+                continue;
+            }
+            
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                VoxelPosition localPos = {x, y, z};
+                voxel_t voxel = voxelAt(localPos);
+                
+                // Skip air voxels
+                if (voxel == static_cast<voxel_t>(CommonVoxel::Air)) continue;
+                
+                // Get voxel data to determine mesh style
+                const VoxelData& voxelData = m_voxelDataManager.getVoxelData(voxel);
+                
+                // Skip voxels with no mesh
+                if (voxelData.meshStyle == VoxelMeshStyle::None) continue;
+                
+                createVoxelMesh(localPos, voxel, voxelData, buffers);
+            }
+        }
+    }
+}
+
+void ChunkMesher::reserveGeometry(ChunkMeshData& buffers) const {
+    // Every visible face as its own quad, and every other voxel as a cross
+    std::size_t faces = 0;
+    std::size_t others = 0;
+    for (int row = 0; row < CHUNK_AREA; row++) {
+        for (const ChunkRowMasks& directionFaces : m_faceMasks.faces) {
+            faces += countSetBits(directionFaces[row]);
+        }
+        others += countSetBits(m_faceMasks.solid[row] & ~m_faceMasks.cubes[row]);
+    }
+    buffers.vertices.reserve(faces * 4 + others * CROSS_VERTICES);
+    buffers.indices.reserve(faces * 6 + others * CROSS_INDICES);
+}
+
+voxel_t ChunkMesher::voxelAt(const VoxelPosition& localPos) const {
+    return m_snapshot->voxels[toPaddedVoxelIndex(localPos)];
+}
+
+void ChunkMesher::createVoxelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                                ChunkMeshData& buffers) {
+    
+    switch (voxelData.meshStyle) {
+        case VoxelMeshStyle::Voxel:
+            // Greedy mode has already emitted these in createGreedyMesh
+            if (m_meshingMode == VoxelMeshingMode::PerFace) {
+                createCubeMesh(localPos, voxelType, voxelData, buffers);
+            }
+            break;
+        case VoxelMeshStyle::Cross:
+            createCrossMesh(localPos, voxelType, voxelData, buffers);
+            break;
+        case VoxelMeshStyle::Model:
+            createModelMesh(localPos, voxelType, voxelData, buffers);
+            break;
+        case VoxelMeshStyle::None:
+            // No mesh to create
+            break;
+        default:
+            // Default to cube mesh
+            createCubeMesh(localPos, voxelType, voxelData, buffers);
+            break;
+    }
+}
+void ChunkMesher::createCubeMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                               ChunkMeshData& buffers) {
+    
+    const int origin[3] = {localPos.x, localPos.y, localPos.z};
+    const int size[3] = {1, 1, 1};
+    
+    // Check each face and only add it if it should be rendered
+    // Order: front (+Z), back (-Z), left (-X), right (+X), bottom (-Y), top (+Y)
+    for (int direction : {5, 4, 0, 1, 2, 3}) {
+        if (isFaceVisible(localPos, direction)) {
+            emitFace(direction, origin, size, faceTextureLayer(voxelData, direction),
+                     buffers.vertices, buffers.indices);
+        }
+    }
+}
+void ChunkMesher::createGreedyMesh(ChunkMeshData& buffers) {
+    // Voxel type of the visible face at each cell of the current slice, 0 for no face
+    std::array<voxel_t, CHUNK_AREA> mask;
+    
+    for (int direction = 0; direction < 6; direction++) {
+        const int axis = CUBE_FACES[direction].axis;
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+        
+        for (int slice = 0; slice < CHUNK_SIZE; slice++) {
+            // Build the face mask for this slice
+            for (int j = 0; j < CHUNK_SIZE; j++) {
+                for (int i = 0; i < CHUNK_SIZE; i++) {
+                    int pos[3];
+                    pos[axis] = slice;
+                    pos[u] = i;
+                    pos[v] = j;
+                    VoxelPosition localPos = {pos[0], pos[1], pos[2]};
+                    
+                    voxel_t faceVoxel = 0;
+                    if (m_faceCullingMode == FaceCullingMode::Bitmask) {
+                        const int row = toRowMaskIndex(pos[0], pos[1]);
+                        if (((m_faceMasks.faces[direction][row] & m_faceMasks.cubes[row]) >> pos[2]) & 1u) {
+                            faceVoxel = voxelAt(localPos);
+                        }
+                    } else {
+                        voxel_t voxel = voxelAt(localPos);
+                        if (voxel != static_cast<voxel_t>(CommonVoxel::Air) &&
+                            m_voxelDataManager.getVoxelData(voxel).meshStyle == VoxelMeshStyle::Voxel &&
+                            shouldRenderFace(localPos, direction)) {
+                            faceVoxel = voxel;
+                        }
+                    }
+                    mask[j * CHUNK_SIZE + i] = faceVoxel;
+                }
+            }
+            
+            // Merge runs of equal faces into rectangles, clearing the mask as they are consumed
+            for (int j = 0; j < CHUNK_SIZE; j++) {
+                for (int i = 0; i < CHUNK_SIZE;) {
+                    voxel_t faceVoxel = mask[j * CHUNK_SIZE + i];
+                    if (faceVoxel == 0) {
+                        i++;
+                        continue;
+                    }
+                    
+                    int width = 1;
+                    while (i + width < CHUNK_SIZE && mask[j * CHUNK_SIZE + i + width] == faceVoxel) {
+                        width++;
+                    }
+                    
+                    int height = 1;
+                    for (; j + height < CHUNK_SIZE; height++) {
+                        const voxel_t* row = &mask[(j + height) * CHUNK_SIZE + i];
+                        if (std::any_of(row, row + width, [&](voxel_t other) { return other != faceVoxel; })) {
+                            break;
+                        }
+                    }
+                    
+                    for (int h = 0; h < height; h++) {
+                        std::fill_n(&mask[(j + h) * CHUNK_SIZE + i], width, voxel_t(0));
+                    }
+                    
+                    int origin[3];
+                    origin[axis] = slice;
+                    origin[u] = i;
+                    origin[v] = j;
+                    int size[3];
+                    size[axis] = 1;
+                    size[u] = width;
+                    size[v] = height;
+                    u32 layer = faceTextureLayer(m_voxelDataManager.getVoxelData(faceVoxel), direction);
+                    emitFace(direction, origin, size, layer, buffers.vertices, buffers.indices);
+                    
+                    i += width;
+                }
+            }
+        }
+    }
+}
+void ChunkMesher::createCrossMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                                ChunkMeshData& buffers) {
+    
+    const u32 layer = voxelData.sideTextureLayer;
+    
+    // Two intersecting planes, each drawn from both sides
+    for (const CrossPlane& plane : CROSS_PLANES) {
+        unsigned int vertexOffset = static_cast<unsigned int>(buffers.vertices.size());
+        for (int i = 0; i < 4; i++) {
+            buffers.vertices.push_back(packVoxelVertex(
+                localPos.x + plane.corners[i][0], localPos.y + plane.corners[i][1],
+                localPos.z + plane.corners[i][2], plane.direction, plane.uvs[i][0], plane.uvs[i][1], layer));
+        }
+        for (unsigned int index : CROSS_PLANE_INDICES) {
+            buffers.indices.push_back(index + vertexOffset);
+        }
+    }
+}
+void ChunkMesher::createModelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                                ChunkMeshData& buffers) {
+    
+    if (voxelData.modelPath.empty()) {
+        // Fallback to regular cube mesh if no model path is specified
+        createCubeMesh(localPos, voxelType, voxelData, buffers);
+        return;
+    }
+    
+    // Check if the model is loaded
+    auto modelIt = m_blockModels.find(voxelData.modelPath);
+    if (modelIt == m_blockModels.end()) {
+        // Model not found, fallback to cube mesh
+        std::cerr << "Model not found: " << voxelData.modelPath << ", using cube mesh fallback" << std::endl;
+        createCubeMesh(localPos, voxelType, voxelData, buffers);
+        return;
+    }
+    
+    const BlockModelGeometry& model = modelIt->second;
+    if (model.indices.empty()) {
+        std::cerr << "Model has no meshes: " << voxelData.modelPath << ", using cube mesh fallback" << std::endl;
+        createCubeMesh(localPos, voxelType, voxelData, buffers);
+        return;
+    }
+    
+    // Append the model's geometry, which keeps the float layout, then move it into place
+    const std::size_t firstVertex = buffers.modelVertices.size();
+    const std::size_t firstIndex = buffers.modelIndices.size();
+    buffers.modelVertices.insert(buffers.modelVertices.end(), model.vertices.begin(), model.vertices.end());
+    buffers.modelIndices.insert(buffers.modelIndices.end(), model.indices.begin(), model.indices.end());
+    
+    // Translate the copied positions to the voxel
+    for (std::size_t i = firstVertex; i < buffers.modelVertices.size(); i += 8) {
+        buffers.modelVertices[i] += localPos.x;
+        buffers.modelVertices[i + 1] += localPos.y;
+        buffers.modelVertices[i + 2] += localPos.z;
+    }
+    
+    // Offset the copied indices past the vertices already there
+    const unsigned int vertexOffset = static_cast<unsigned int>(firstVertex / 8);
+    for (std::size_t i = firstIndex; i < buffers.modelIndices.size(); i++) {
+        buffers.modelIndices[i] += vertexOffset;
+    }
+}
+
+bool ChunkMesher::shouldRenderFace(const VoxelPosition& localPos, int direction) const {
+    // Neighbours across the chunk's sides are in the padding, so every face is one read
+    voxel_t neighborVoxel = m_snapshot->voxels[toPaddedVoxelIndex(localPos) + PADDED_NEIGHBOUR_OFFSETS[direction]];
+    return neighborVoxel == static_cast<voxel_t>(CommonVoxel::Air);
+}
+
+bool ChunkMesher::isFaceVisible(const VoxelPosition& localPos, int direction) const {
+    if (m_faceCullingMode == FaceCullingMode::Bitmask) {
+        return (m_faceMasks.faces[direction][toRowMaskIndex(localPos.x, localPos.y)] >> localPos.z) & 1u;
+    }
+    return shouldRenderFace(localPos, direction);
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "chunk.h"
+#include "chunk_face_masks.h"
+#include "packed_vertex.h"
+#include "voxel_data.h"
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ChunkManager;
+
+/**
+ * @brief How VoxelMeshStyle::Voxel blocks are turned into chunk geometry
+ */
+enum class VoxelMeshingMode {
+    PerFace,    // One quad for every visible voxel face
+    Greedy,     // Coplanar faces of the same voxel type merged into rectangles
+};
+
+/**
+ * @brief How the mesher decides which voxel faces are visible
+ */
+enum class FaceCullingMode {
+    PerVoxel,   // shouldRenderFace for every face of every voxel
+    Bitmask,    // Whole rows of faces at once from occupancy bitmasks (see ChunkFaceMasks)
+};
+
+/**
+ * @brief The geometry of a block model that the mesher copies into chunks
+ * Kept apart from Model, so meshing needs neither a GL context nor a model loader
+ */
+struct BlockModelGeometry {
+    // 8 floats per vertex: position, normal, texture coordinates
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Indexed by VoxelData::modelPath
+using BlockModelMap = std::unordered_map<std::string, BlockModelGeometry>;
+
+/**
+ * @brief Copy of a chunk and the voxels of its 6 neighbours that touch it, everything
+ * meshing reads, so it can be meshed away from the ChunkManager
+ */
+struct ChunkMeshSnapshot {
+    ChunkPosition position;
+    
+    // The padding is air where no neighbour is loaded, so those faces are drawn,
+    // and along the edges and corners, which no face touches
+    PaddedVoxelArray voxels;
+};
+
+/**
+ * @brief CPU side geometry of a chunk, built without a GL context
+ * Can be built on any thread, kept, or measured, and is uploaded by ChunkMeshUploader
+ */
+struct ChunkMeshData {
+    // Voxel and cross geometry
+    std::vector<PackedVoxelVertex> vertices;
+    std::vector<unsigned int> indices;
+    
+    // Model geometry, 8 floats per vertex: position, normal, texture coordinates
+    std::vector<float> modelVertices;
+    std::vector<unsigned int> modelIndices;
+    
+    bool empty() const { return indices.empty() && modelIndices.empty(); }
+    
+    /**
+     * @brief Bytes of vertex and index data, what uploading the mesh copies
+     */
+    std::size_t byteSize() const {
+        return vertices.size() * sizeof(PackedVoxelVertex) + indices.size() * sizeof(unsigned int) +
+               modelVertices.size() * sizeof(float) + modelIndices.size() * sizeof(unsigned int);
+    }
+};
+
+/**
+ * @brief Copy a chunk and the bordering voxels of its neighbours into an existing snapshot,
+ * eg one from an ObjectPool
+ * @param chunkManager The chunks to copy from
+ * @param chunkPos Position of the chunk
+ * @param snapshot Overwritten with the copy
+ * @return false There is no chunk at chunkPos, and the snapshot was left as it was
+ */
+bool fillChunkMeshSnapshot(const ChunkManager& chunkManager, const ChunkPosition& chunkPos,
+                           ChunkMeshSnapshot& snapshot);
+
+/**
+ * @brief Copy a chunk and the bordering voxels of its neighbours out of the chunk manager
+ * @param chunkManager The chunks to copy from
+ * @param chunkPos Position of the chunk
+ * @return The snapshot, or nullptr if there is no chunk at chunkPos
+ */
+std::unique_ptr<ChunkMeshSnapshot> createChunkMeshSnapshot(const ChunkManager& chunkManager,
+                                                           const ChunkPosition& chunkPos);
+
+/**
+ * @brief Build the geometry of a chunk from a snapshot of it and its neighbours
+ * Reads nothing but its arguments, so it can run on any thread and needs no GL context
+ * @param snapshot The chunk and its neighbours
+ * @param voxelDataManager Voxel data used to find how each voxel is meshed
+ * @param blockModels Geometry of the VoxelMeshStyle::Model voxels
+ * @param meshingMode How solid blocks are meshed
+ * @param faceCullingMode How visible faces are found
+ * @return ChunkMeshData The geometry, empty if the chunk has none
+ */
+ChunkMeshData buildChunkMesh(const ChunkMeshSnapshot& snapshot, const VoxelDataManager& voxelDataManager,
+                             const BlockModelMap& blockModels, VoxelMeshingMode meshingMode,
+                             FaceCullingMode faceCullingMode);
+
+/**
+ * @brief Check if a chunk would mesh to nothing, without copying or scanning its voxels
+ * True when the chunk is all air or all a voxel with no mesh, or all one cube voxel
+ * with every neighbour loaded and not air where it touches the chunk
+ * @param chunkManager The chunks to check
+ * @param voxelDataManager Voxel data used to find how the chunk's voxel is meshed
+ * @param chunkPos Position of the chunk
+ * @return true The chunk has no geometry in any meshing or face culling mode
+ */
+bool isChunkMeshEmpty(const ChunkManager& chunkManager, const VoxelDataManager& voxelDataManager,
+                      const ChunkPosition& chunkPos);
+
+/**
+ * @brief Builds chunk geometry from a snapshot
+ * Only reads the voxel data and block models it is given, so separate meshers
+ * can run on different threads at the same time
+ */
+class ChunkMesher {
+public:
+    ChunkMesher(const VoxelDataManager& voxelDataManager, const BlockModelMap& blockModels,
+                VoxelMeshingMode meshingMode, FaceCullingMode faceCullingMode);
+
+    /**
+     * @brief Generate the geometry of a chunk
+     * Emitting geometry makes no heap allocations of its own. With FaceCullingMode::Bitmask
+     * the buffers are reserved up front for the most geometry the chunk can produce, and
+     * reusing buffers for another chunk keeps their capacity, so meshing into buffers that
+     * already grew to fit does not allocate at all. Model geometry may still grow them.
+     * @param snapshot The chunk and its neighbours
+     * @param buffers Output geometry, replacing what they held
+     */
+    void build(const ChunkMeshSnapshot& snapshot, ChunkMeshData& buffers);
+
+private:
+    const VoxelDataManager& m_voxelDataManager;
+    const BlockModelMap& m_blockModels;
+    VoxelMeshingMode m_meshingMode;
+    FaceCullingMode m_faceCullingMode;
+    
+    // Chunk being built
+    const ChunkMeshSnapshot* m_snapshot;
+    
+    // Visible faces of the current chunk, filled when using FaceCullingMode::Bitmask
+    ChunkFaceMasks m_faceMasks;
+    
+    voxel_t voxelAt(const VoxelPosition& localPos) const;
+    
+    /**
+     * @brief Reserve buffers for the most geometry the face masks allow
+     * Bounded by a quad for every visible face of every voxel, plus a cross for every
+     * voxel that is not a cube
+     */
+    void reserveGeometry(ChunkMeshData& buffers) const;
+    
+    /**
+     * @brief Create cube vertices for a voxel at local position
+     * @param localPos Local position within chunk
+     * @param voxelType Type of voxel
+     * @param voxelData Data for the voxel (mesh style, textures, etc.)
+     * @param buffers Output geometry
+     */
+    void createVoxelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                        ChunkMeshData& buffers);
+
+    /**
+     * @brief Create cube mesh for solid blocks
+     */
+    void createCubeMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                       ChunkMeshData& buffers);
+
+    /**
+     * @brief Create merged faces for every VoxelMeshStyle::Voxel block of the current chunk
+     * Visible faces in each slice are merged into maximal rectangles of the same voxel type,
+     * with texture coordinates scaled so the texture tiles once per voxel
+     */
+    void createGreedyMesh(ChunkMeshData& buffers);
+
+    /**
+     * @brief Create cross mesh for plants/vegetation
+     */
+    void createCrossMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                        ChunkMeshData& buffers);
+                        
+    /**
+     * @brief Create mesh from loaded 3D model
+     */
+    void createModelMesh(const VoxelPosition& localPos, voxel_t voxelType, const VoxelData& voxelData,
+                        ChunkMeshData& buffers);
+    
+    /**
+     * @brief Check if a face should be rendered (is the adjacent voxel transparent?)
+     * @param localPos Local position within chunk
+     * @param direction Direction to check (0=left, 1=right, 2=bottom, 3=top, 4=back, 5=front)
+     * @return true if face should be rendered
+     */
+    bool shouldRenderFace(const VoxelPosition& localPos, int direction) const;
+    
+    /**
+     * @brief Check if a face of the current chunk is visible using the selected FaceCullingMode
+     * @param localPos Local position within chunk
+     * @param direction Direction to check (0=left, 1=right, 2=bottom, 3=top, 4=back, 5=front)
+     * @return true if face should be rendered
+     */
+    bool isFaceVisible(const VoxelPosition& localPos, int direction) const;
+};
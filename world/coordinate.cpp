@@ -8,6 +8,21 @@ int toLocalVoxelIndex(const VoxelPosition& position)
     return position.y * (CHUNK_AREA) + position.z * CHUNK_SIZE + position.x;
 }
 
+ChunkPosition neighbourChunkPosition(const ChunkPosition& position, int direction)
+{
+    const auto& p = position;
+    switch (direction) {
+        // clang-format off
+        case 0: return {p.x - 1, p.y, p.z};
+        case 1: return {p.x + 1, p.y, p.z};
+        case 2: return {p.x, p.y - 1, p.z};
+        case 3: return {p.x, p.y + 1, p.z};
+        case 4: return {p.x, p.y, p.z - 1};
+        default: return {p.x, p.y, p.z + 1};
+        // clang-format on
+    }
+}
+
 ChunkPosition worldToChunkPosition(const glm::vec3& position)
 {
     return toChunkPosition(toVoxelPosition(position));
@@ -18,11 +33,11 @@ ChunkPosition toChunkPosition(const VoxelPosition& position)
     int x = position.x;
     int y = position.y;
     int z = position.z;
-    //@TODO Might be a better way to deal with negative coordinates?
+    // Round towards negative infinity so that -CHUNK_SIZE lands in chunk -1
     return {
-        x < 0 ? ((x - CHUNK_SIZE) / CHUNK_SIZE) : (x / CHUNK_SIZE),
-        y < 0 ? ((y - CHUNK_SIZE) / CHUNK_SIZE) : (y / CHUNK_SIZE),
-        z < 0 ? ((z - CHUNK_SIZE) / CHUNK_SIZE) : (z / CHUNK_SIZE),
+        x < 0 ? ((x + 1) / CHUNK_SIZE - 1) : (x / CHUNK_SIZE),
+        y < 0 ? ((y + 1) / CHUNK_SIZE - 1) : (y / CHUNK_SIZE),
+        z < 0 ? ((z + 1) / CHUNK_SIZE - 1) : (z / CHUNK_SIZE),
     };
 }
 
@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <unordered_map>
+#include <unordered_set>
 
 // Simple 3D vector structure for chunk and voxel positions
 struct Vector3i {
@@ -24,17 +25,38 @@ struct Vector3i {
 using ChunkPosition = Vector3i;
 using VoxelPosition = Vector3i;
 
+/**
+ * @brief 64 bit hash of a position with every input bit affecting every output bit
+ * The coordinates are packed into 21 bits each and mixed with the SplitMix64
+ * finaliser, so axis aligned rows and planes of positions do not collide
+ *
+ * @param position The position to hash
+ * @return u64 The hash
+ */
+inline u64 hashChunkPosition(const ChunkPosition& position)
+{
+    u64 key = (u64(u32(position.x)) & 0x1FFFFF) | ((u64(u32(position.y)) & 0x1FFFFF) << 21) |
+              ((u64(u32(position.z)) & 0x1FFFFF) << 42);
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ull;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBull;
+    key ^= key >> 31;
+    return key;
+}
+
 struct ChunkPositionHash {
-    // http://www.beosil.com/download/CollisionDetectionHashing_VMV03.pdf
     std::size_t operator()(const ChunkPosition& position) const
     {
-        return (position.x * 88339) ^ (position.y * 91967) ^ (position.z * 126323);
+        return static_cast<std::size_t>(hashChunkPosition(position));
     }
 };
 
 template <typename T>
 using ChunkPositionMap = std::unordered_map<ChunkPosition, T, ChunkPositionHash>;
 
+using ChunkPositionSet = std::unordered_set<ChunkPosition, ChunkPositionHash>;
+
 /**
  * @brief Converts a local voxel position to an index of a voxel array
  *
@@ -43,6 +65,16 @@ using ChunkPositionMap = std::unordered_map<ChunkPosition, T, ChunkPositionHash>
  */
 int toLocalVoxelIndex(const VoxelPosition& position);
 
+/**
+ * @brief Gets the position of a chunk next to another
+ *
+ * @param position The chunk position
+ * @param direction The direction of the neighbour (0=left(-X), 1=right(+X),
+ * 2=bottom(-Y), 3=top(+Y), 4=back(-Z), 5=front(+Z))
+ * @return ChunkPosition The neighbouring chunk position
+ */
+ChunkPosition neighbourChunkPosition(const ChunkPosition& position, int direction);
+
 /**
  * @brief Converts world coordinates (Eg player position) to chunk coordinates
  *
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "coordinate.h"
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Open addressing hash map from chunk positions to values
+ * Slots hold the position and a pointer next to each other, and are probed
+ * linearly, so a lookup usually touches one cache line. Values are allocated
+ * individually, so their addresses stay the same when the table grows or other
+ * entries are erased. Erasing shifts later entries back rather than leaving
+ * tombstones, so lookups do not slow down over time.
+ */
+template <typename T>
+class FlatChunkMap final {
+  public:
+    struct Slot {
+        ChunkPosition position;
+        T* value = nullptr;
+    };
+
+    /**
+     * @brief Iterates over the occupied slots, in no particular order
+     */
+    class const_iterator {
+      public:
+        const_iterator(const Slot* slot, const Slot* end)
+            : m_slot(slot)
+            , m_end(end)
+        {
+            skipEmpty();
+        }
+
+        const Slot& operator*() const
+        {
+            return *m_slot;
+        }
+
+        const Slot* operator->() const
+        {
+            return m_slot;
+        }
+
+        const_iterator& operator++()
+        {
+            ++m_slot;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator!=(const const_iterator& other) const
+        {
+            return m_slot != other.m_slot;
+        }
+
+      private:
+        void skipEmpty()
+        {
+            while (m_slot != m_end && !m_slot->value) {
+                ++m_slot;
+            }
+        }
+
+        const Slot* m_slot;
+        const Slot* m_end;
+    };
+
+    FlatChunkMap() = default;
+    FlatChunkMap(const FlatChunkMap&) = delete;
+    FlatChunkMap& operator=(const FlatChunkMap&) = delete;
+
+    ~FlatChunkMap()
+    {
+        clear();
+    }
+
+    T* find(const ChunkPosition& position)
+    {
+        if (m_slots.empty()) {
+            return nullptr;
+        }
+        for (std::size_t i = slotOf(position);; i = (i + 1) & m_mask) {
+            Slot& slot = m_slots[i];
+            if (!slot.value) {
+                return nullptr;
+            }
+            if (slot.position == position) {
+                return slot.value;
+            }
+        }
+    }
+
+    const T* find(const ChunkPosition& position) const
+    {
+        return const_cast<FlatChunkMap*>(this)->find(position);
+    }
+
+    bool contains(const ChunkPosition& position) const
+    {
+        return find(position) != nullptr;
+    }
+
+    /**
+     * @brief Add a value at a position unless there already is one
+     *
+     * @param position The position to add at
+     * @param args Constructor arguments of the value
+     * @return std::pair<T*, bool> The value at the position, and whether it was added
+     */
+    template <typename... Args>
+    std::pair<T*, bool> tryEmplace(const ChunkPosition& position, Args&&... args)
+    {
+        if (T* existing = find(position)) {
+            return {existing, false};
+        }
+        // Keep the table at most 3/4 full
+        if ((m_size + 1) * 4 > m_slots.size() * 3) {
+            rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+        }
+        T* value = new T(std::forward<Args>(args)...);
+        insertSlot({position, value});
+        m_size++;
+        return {value, true};
+    }
+
+    /**
+     * @brief Remove and destroy the value at a position
+     *
+     * @param position The position to remove
+     * @return true A value was removed
+     */
+    bool erase(const ChunkPosition& position)
+    {
+        if (m_slots.empty()) {
+            return false;
+        }
+        std::size_t i = slotOf(position);
+        while (m_slots[i].value && m_slots[i].position != position) {
+            i = (i + 1) & m_mask;
+        }
+        if (!m_slots[i].value) {
+            return false;
+        }
+        delete m_slots[i].value;
+        m_slots[i].value = nullptr;
+        m_size--;
+
+        // Shift back later entries of the probe run that would no longer be reachable
+        std::size_t hole = i;
+        for (std::size_t j = (i + 1) & m_mask; m_slots[j].value; j = (j + 1) & m_mask) {
+            std::size_t home = slotOf(m_slots[j].position);
+            // Move if the hole lies between the entry's home slot and where it is now
+            if (((j - home) & m_mask) >= ((j - hole) & m_mask)) {
+                m_slots[hole] = m_slots[j];
+                m_slots[j].value = nullptr;
+                hole = j;
+            }
+        }
+        return true;
+    }
+
+    void clear()
+    {
+        for (Slot& slot : m_slots) {
+            delete slot.value;
+            slot.value = nullptr;
+        }
+        m_size = 0;
+    }
+
+    /**
+     * @brief Make room for a number of values without growing
+     *
+     * @param count Number of values
+     */
+    void reserve(std::size_t count)
+    {
+        std::size_t capacity = 16;
+        while (count * 4 > capacity * 3) {
+            capacity *= 2;
+        }
+        if (capacity > m_slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    const_iterator begin() const
+    {
+        return {m_slots.data(), m_slots.data() + m_slots.size()};
+    }
+
+    const_iterator end() const
+    {
+        return {m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()};
+    }
+
+  private:
+    std::size_t slotOf(const ChunkPosition& position) const
+    {
+        return static_cast<std::size_t>(hashChunkPosition(position)) & m_mask;
+    }
+
+    void insertSlot(const Slot& entry)
+    {
+        std::size_t i = slotOf(entry.position);
+        while (m_slots[i].value) {
+            i = (i + 1) & m_mask;
+        }
+        m_slots[i] = entry;
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        assert((capacity & (capacity - 1)) == 0);
+        std::vector<Slot> old(capacity);
+        old.swap(m_slots);
+        m_mask = capacity - 1;
+        for (const Slot& slot : old) {
+            if (slot.value) {
+                insertSlot(slot);
+            }
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    std::size_t m_mask = 0;
+    std::size_t m_size = 0;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../types.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Object counts of an ObjectPool, for sizing it
+ */
+struct ObjectPoolStats {
+    u32 created = 0;    // Objects allocated since the pool was created
+    u32 inUse = 0;      // Objects acquired and not released yet
+    u32 idle = 0;       // Objects waiting to be reused
+    u32 peakInUse = 0;  // Most objects that were in use at once
+};
+
+/**
+ * @brief Thread safe pool of reusable objects, for large buffers that would otherwise
+ * be allocated and freed for every job
+ * Released objects keep their contents, so containers in them keep their capacity and
+ * are already sized for the next use. The pool owns every object it created, so ones
+ * still held when it is destroyed, eg by jobs a ThreadPool discarded, are freed too.
+ */
+template <typename T>
+class ObjectPool final {
+  public:
+    /**
+     * @brief Create an empty pool
+     *
+     * @param maxIdle How many released objects are kept for reuse, more are freed
+     */
+    explicit ObjectPool(std::size_t maxIdle) : m_maxIdle(maxIdle)
+    {
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /**
+     * @brief Take an idle object, or create one if there is none
+     *
+     * @return T* The object, owned by the pool until it is released
+     */
+    T* acquire()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        T* object;
+        if (!m_idle.empty()) {
+            object = m_idle.back();
+            m_idle.pop_back();
+        }
+        else {
+            m_objects.push_back(std::make_unique<T>());
+            object = m_objects.back().get();
+            m_created++;
+        }
+        m_inUse++;
+        m_peakInUse = std::max(m_peakInUse, m_inUse);
+        return object;
+    }
+
+    /**
+     * @brief Give an object back to be reused
+     *
+     * @param object An object returned by acquire
+     */
+    void release(T* object)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inUse--;
+        if (m_idle.size() < m_maxIdle) {
+            m_idle.push_back(object);
+            return;
+        }
+        destroy(object);
+    }
+
+    /**
+     * @brief Change how many released objects are kept, freeing idle ones over the limit
+     *
+     * @param maxIdle How many released objects are kept for reuse
+     */
+    void setMaxIdle(std::size_t maxIdle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxIdle = maxIdle;
+        while (m_idle.size() > m_maxIdle) {
+            T* object = m_idle.back();
+            m_idle.pop_back();
+            destroy(object);
+        }
+    }
+
+    ObjectPoolStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ObjectPoolStats stats;
+        stats.created = m_created;
+        stats.inUse = m_inUse;
+        stats.idle = static_cast<u32>(m_idle.size());
+        stats.peakInUse = m_peakInUse;
+        return stats;
+    }
+
+  private:
+    /**
+     * @brief Free an object that is neither in use nor idle, with the mutex held
+     * Only happens after a peak, when the pool shrinks back
+     */
+    void destroy(T* object)
+    {
+        auto owner = std::find_if(m_objects.begin(), m_objects.end(),
+                                  [object](const std::unique_ptr<T>& owned) { return owned.get() == object; });
+        std::swap(*owner, m_objects.back());
+        m_objects.pop_back();
+    }
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<T>> m_objects;
+    std::vector<T*> m_idle;
+    std::size_t m_maxIdle;
+    u32 m_created = 0;
+    u32 m_inUse = 0;
+    u32 m_peakInUse = 0;
+};
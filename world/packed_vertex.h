@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../types.h"
+#include "world_constants.h"
+
+/**
+ * @brief 8 byte vertex used for voxel geometry, decoded in shaders/vertex.vs
+ *
+ * position: bits 0-5 X, 6-11 Y, 12-17 Z of the cube corner (0 to CHUNK_SIZE),
+ *           bits 18-20 the face direction, which selects the normal
+ * texture:  bits 0-5 U, 6-11 V texture coordinate, counted in whole voxels,
+ *           bits 12-23 the layer of the block texture array
+ *
+ * Voxels are centred on their local position, so a corner value c is drawn at c - 0.5
+ */
+struct PackedVoxelVertex {
+    u32 position;
+    u32 texture;
+};
+
+static_assert(sizeof(PackedVoxelVertex) == 8, "PackedVoxelVertex must stay 8 bytes");
+
+// Texture layers a packed vertex can address
+constexpr u32 MAX_TEXTURE_LAYERS = 1 << 12;
+
+/**
+ * @brief Pack a voxel vertex
+ *
+ * @param x Corner X, 0 to CHUNK_SIZE
+ * @param y Corner Y, 0 to CHUNK_SIZE
+ * @param z Corner Z, 0 to CHUNK_SIZE
+ * @param direction Face direction (0=left, 1=right, 2=bottom, 3=top, 4=back, 5=front)
+ * @param u Texture U, 0 to CHUNK_SIZE
+ * @param v Texture V, 0 to CHUNK_SIZE
+ * @param layer Block texture array layer, below MAX_TEXTURE_LAYERS
+ * @return PackedVoxelVertex The packed vertex
+ */
+inline PackedVoxelVertex packVoxelVertex(int x, int y, int z, int direction, int u, int v,
+                                         u32 layer)
+{
+    return {
+        static_cast<u32>(x) | static_cast<u32>(y) << 6 | static_cast<u32>(z) << 12 |
+            static_cast<u32>(direction) << 18,
+        static_cast<u32>(u) | static_cast<u32>(v) << 6 | layer << 12,
+    };
+}
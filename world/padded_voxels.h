@@ -0,0 +1,32 @@
+#pragma once
+
+#include "coordinate.h"
+#include "paletted_voxels.h"
+#include <array>
+
+// A chunk with a one voxel border on every side
+constexpr int PADDED_CHUNK_SIZE = CHUNK_SIZE + 2;
+constexpr int PADDED_CHUNK_AREA = PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE;
+constexpr int PADDED_CHUNK_VOLUME = PADDED_CHUNK_AREA * PADDED_CHUNK_SIZE;
+
+/**
+ * @brief The voxels of a chunk surrounded by the touching voxels of its 6 neighbours
+ * Laid out like VoxelArray, Y then Z then X, with local position (-1, -1, -1) first
+ */
+using PaddedVoxelArray = std::array<voxel_t, PADDED_CHUNK_VOLUME>;
+
+/**
+ * @brief Get the index of a local voxel position in a PaddedVoxelArray
+ *
+ * @param position Local position, -1 to CHUNK_SIZE on each axis
+ * @return int The index
+ */
+inline int toPaddedVoxelIndex(const VoxelPosition& position)
+{
+    return (position.y + 1) * PADDED_CHUNK_AREA + (position.z + 1) * PADDED_CHUNK_SIZE + position.x + 1;
+}
+
+// Index offset to the next voxel in each direction: 0=left(-X), 1=right(+X), 2=bottom(-Y), 3=top(+Y), 4=back(-Z), 5=front(+Z)
+constexpr int PADDED_NEIGHBOUR_OFFSETS[6] = {
+    -1, 1, -PADDED_CHUNK_AREA, PADDED_CHUNK_AREA, -PADDED_CHUNK_SIZE, PADDED_CHUNK_SIZE,
+};
@@ -0,0 +1,202 @@
+#include "paletted_voxels.h"
+
+#include <cassert>
+
+namespace {
+    constexpr int WORD_BITS = 64;
+
+    int bitsForEntries(int entries)
+    {
+        if (entries <= 1) return 0;
+        if (entries <= 2) return 1;
+        if (entries <= 4) return 2;
+        if (entries <= 16) return 4;
+        return 8;
+    }
+
+    int wordCount(int bits)
+    {
+        return bits == 0 ? 0 : CHUNK_VOLUME * bits / WORD_BITS;
+    }
+
+    u32 readPacked(const std::vector<u64>& words, int bits, int index)
+    {
+        int bit = index * bits;
+        u64 mask = (u64{1} << bits) - 1;
+        return static_cast<u32>((words[bit / WORD_BITS] >> (bit % WORD_BITS)) & mask);
+    }
+
+    void writePacked(std::vector<u64>& words, int bits, int index, u32 paletteIndex)
+    {
+        int bit = index * bits;
+        u64 mask = ((u64{1} << bits) - 1) << (bit % WORD_BITS);
+        u64& word = words[bit / WORD_BITS];
+        word = (word & ~mask) | (u64{paletteIndex} << (bit % WORD_BITS));
+    }
+} // namespace
+
+PalettedVoxels::PalettedVoxels(voxel_t voxel)
+    : m_palette{voxel}
+    , m_counts{static_cast<u16>(CHUNK_VOLUME)}
+{
+    static_assert(CHUNK_VOLUME <= 0xFFFF, "palette counts are 16 bit");
+}
+
+voxel_t PalettedVoxels::get(int index) const
+{
+    return m_bits == 0 ? m_palette[0] : m_palette[readIndex(index)];
+}
+
+void PalettedVoxels::set(int index, voxel_t voxel)
+{
+    u32 old = m_bits == 0 ? 0 : readIndex(index);
+    if (m_palette[old] == voxel) {
+        return;
+    }
+
+    // Find the voxel in the palette, or a free entry to put it in
+    int entry = -1;
+    int freeEntry = -1;
+    for (int i = 0; i < static_cast<int>(m_palette.size()); i++) {
+        if (m_counts[i] == 0) {
+            if (freeEntry == -1) freeEntry = i;
+        }
+        else if (m_palette[i] == voxel) {
+            entry = i;
+            break;
+        }
+    }
+    if (entry == -1) {
+        if (freeEntry == -1) {
+            freeEntry = static_cast<int>(m_palette.size());
+            m_palette.push_back(voxel);
+            m_counts.push_back(0);
+        }
+        entry = freeEntry;
+        m_palette[entry] = voxel;
+        m_usedEntries++;
+        if (bitsForEntries(static_cast<int>(m_palette.size())) > m_bits) {
+            repack(bitsForEntries(static_cast<int>(m_palette.size())));
+        }
+    }
+
+    writeIndex(index, static_cast<u32>(entry));
+    m_counts[entry]++;
+    if (--m_counts[old] == 0) {
+        m_usedEntries--;
+
+        // Shrink when the palette fits a smaller width with room to spare. A single voxel
+        // left at 1 bit stays packed until the next assign, so placing and removing one
+        // voxel in a uniform chunk does not repack either way.
+        if (bitsForEntries(m_usedEntries * 2) < m_bits) {
+            compact();
+        }
+    }
+}
+
+void PalettedVoxels::assign(const VoxelArray& voxels)
+{
+    std::array<int, 256> entries;
+    entries.fill(-1);
+    m_palette.clear();
+    m_counts.clear();
+    for (voxel_t voxel : voxels) {
+        if (entries[voxel] == -1) {
+            entries[voxel] = static_cast<int>(m_palette.size());
+            m_palette.push_back(voxel);
+            m_counts.push_back(0);
+        }
+        m_counts[entries[voxel]]++;
+    }
+    m_usedEntries = static_cast<int>(m_palette.size());
+    m_bits = bitsForEntries(m_usedEntries);
+    m_words.assign(wordCount(m_bits), 0);
+    if (m_bits == 0) {
+        return;
+    }
+    for (int i = 0; i < CHUNK_VOLUME; i++) {
+        writeIndex(i, static_cast<u32>(entries[voxels[i]]));
+    }
+}
+
+void PalettedVoxels::copyTo(VoxelArray& voxels) const
+{
+    if (m_bits == 0) {
+        voxels.fill(m_palette[0]);
+        return;
+    }
+    const int perWord = WORD_BITS / m_bits;
+    const u64 mask = (u64{1} << m_bits) - 1;
+    int i = 0;
+    for (u64 word : m_words) {
+        for (int j = 0; j < perWord; j++) {
+            voxels[i++] = m_palette[word & mask];
+            word >>= m_bits;
+        }
+    }
+}
+
+bool PalettedVoxels::isUniform() const
+{
+    return m_usedEntries == 1;
+}
+
+int PalettedVoxels::bitsPerVoxel() const
+{
+    return m_bits;
+}
+
+std::size_t PalettedVoxels::memoryUsage() const
+{
+    return sizeof(*this) + m_palette.capacity() * sizeof(voxel_t) +
+           m_counts.capacity() * sizeof(u16) + m_words.capacity() * sizeof(u64);
+}
+
+u32 PalettedVoxels::readIndex(int index) const
+{
+    return readPacked(m_words, m_bits, index);
+}
+
+void PalettedVoxels::writeIndex(int index, u32 paletteIndex)
+{
+    writePacked(m_words, m_bits, index, paletteIndex);
+}
+
+void PalettedVoxels::repack(int bits)
+{
+    assert(bitsForEntries(static_cast<int>(m_palette.size())) <= bits);
+    const int oldBits = m_bits;
+    m_bits = bits;
+    if (oldBits == 0 || bits == 0) {
+        // Every index was or will be entry 0
+        m_words.assign(wordCount(bits), 0);
+        m_words.shrink_to_fit();
+        return;
+    }
+
+    // Repacked in place: index i never moves below where the indices before it are
+    // still unread, so widening walks down from the end and narrowing walks up
+    if (bits > oldBits) {
+        m_words.resize(wordCount(bits), 0);
+        for (int i = CHUNK_VOLUME - 1; i >= 0; i--) {
+            writePacked(m_words, bits, i, readPacked(m_words, oldBits, i));
+        }
+    }
+    else if (bits < oldBits) {
+        for (int i = 0; i < CHUNK_VOLUME; i++) {
+            writePacked(m_words, bits, i, readPacked(m_words, oldBits, i));
+        }
+        m_words.resize(wordCount(bits));
+        m_words.shrink_to_fit();
+    }
+}
+
+void PalettedVoxels::compact()
+{
+    VoxelArray voxels;
+    copyTo(voxels);
+    assign(voxels);
+    m_palette.shrink_to_fit();
+    m_counts.shrink_to_fit();
+    m_words.shrink_to_fit();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../types.h"
+#include "world_constants.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+using VoxelArray = std::array<voxel_t, CHUNK_VOLUME>;
+
+/**
+ * @brief The voxels of a chunk, stored as a palette of distinct voxels plus a
+ * bit packed palette index per voxel
+ * Indices use 0, 1, 2, 4 or 8 bits, the fewest that fit the palette. A chunk of
+ * one voxel type has no indices at all. The width grows when a set needs a new
+ * palette entry, and shrinks again once the palette fits a smaller width with
+ * room to spare, so toggling one voxel back and forth does not repack every time.
+ * A chunk set back to one voxel type keeps 1 bit indices until the next assign.
+ */
+class PalettedVoxels final {
+  public:
+    /**
+     * @brief Create storage where every voxel is the given voxel
+     *
+     * @param voxel The voxel to fill with
+     */
+    explicit PalettedVoxels(voxel_t voxel = 0);
+
+    voxel_t get(int index) const;
+    void set(int index, voxel_t voxel);
+
+    /**
+     * @brief Replace every voxel, packed at the smallest width that fits
+     *
+     * @param voxels The new voxels
+     */
+    void assign(const VoxelArray& voxels);
+
+    /**
+     * @brief Unpack every voxel
+     *
+     * @param voxels Array to write the voxels to
+     */
+    void copyTo(VoxelArray& voxels) const;
+
+    /**
+     * @brief Check if every voxel is the same
+     *
+     * @return true All the voxels are the same
+     */
+    bool isUniform() const;
+
+    int bitsPerVoxel() const;
+
+    /**
+     * @brief Heap and inline memory used by the storage
+     *
+     * @return std::size_t Size in bytes
+     */
+    std::size_t memoryUsage() const;
+
+  private:
+    u32 readIndex(int index) const;
+    void writeIndex(int index, u32 paletteIndex);
+
+    /**
+     * @brief Repack the indices at a different width, keeping the palette order
+     *
+     * @param bits The new width, large enough for the palette
+     */
+    void repack(int bits);
+
+    /**
+     * @brief Drop unused palette entries and repack at the smallest width that fits
+     */
+    void compact();
+
+    // Palette entry of each index, entries with a count of 0 are free for reuse
+    std::vector<voxel_t> m_palette;
+    std::vector<u16> m_counts;
+
+    // Packed indices, a word always holds a whole number of them
+    std::vector<u64> m_words;
+    int m_bits = 0;
+    int m_usedEntries = 1;
+};
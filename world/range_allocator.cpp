@@ -0,0 +1,75 @@
+#include "range_allocator.h"
+
+#include <cassert>
+#include <iterator>
+
+RangeAllocator::RangeAllocator(u32 capacity)
+    : m_capacity(0)
+    , m_used(0)
+{
+    grow(capacity);
+}
+
+u32 RangeAllocator::allocate(u32 size)
+{
+    assert(size > 0);
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it) {
+        if (it->second < size) {
+            continue;
+        }
+        u32 offset = it->first;
+        u32 remaining = it->second - size;
+        m_freeRanges.erase(it);
+        if (remaining > 0) {
+            m_freeRanges.emplace(offset + size, remaining);
+        }
+        m_used += size;
+        return offset;
+    }
+    return INVALID_OFFSET;
+}
+
+void RangeAllocator::release(u32 offset, u32 size)
+{
+    assert(size > 0 && offset + size <= m_capacity);
+    m_used -= size;
+
+    auto next = m_freeRanges.lower_bound(offset);
+    if (next != m_freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            m_freeRanges.erase(previous);
+        }
+    }
+    if (next != m_freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        m_freeRanges.erase(next);
+    }
+    m_freeRanges.emplace(offset, size);
+}
+
+void RangeAllocator::grow(u32 capacity)
+{
+    if (capacity <= m_capacity) {
+        return;
+    }
+    u32 added = capacity - m_capacity;
+    u32 offset = m_capacity;
+    m_capacity = capacity;
+
+    // Counted as used so release() can merge it like any other range
+    m_used += added;
+    release(offset, added);
+}
+
+u32 RangeAllocator::capacity() const
+{
+    return m_capacity;
+}
+
+u32 RangeAllocator::used() const
+{
+    return m_used;
+}
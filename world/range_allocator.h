@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../types.h"
+#include <map>
+
+/**
+ * @brief First fit allocator of ranges within [0, capacity)
+ * Only tracks offsets, the memory itself lives elsewhere (e.g. in a GPU buffer)
+ */
+class RangeAllocator final {
+  public:
+    static constexpr u32 INVALID_OFFSET = 0xFFFFFFFF;
+
+    explicit RangeAllocator(u32 capacity = 0);
+
+    /**
+     * @brief Reserve a range
+     *
+     * @param size Size of the range, more than 0
+     * @return u32 Offset of the range, or INVALID_OFFSET if no free range is large enough
+     */
+    u32 allocate(u32 size);
+
+    /**
+     * @brief Return a range from allocate, merging it with neighbouring free ranges
+     *
+     * @param offset Offset of the range
+     * @param size Size the range was allocated with
+     */
+    void release(u32 offset, u32 size);
+
+    /**
+     * @brief Add free space to the end
+     *
+     * @param capacity New capacity, at least the current one
+     */
+    void grow(u32 capacity);
+
+    u32 capacity() const;
+    u32 used() const;
+
+  private:
+    // Offset to size of each free range, never adjacent to each other
+    std::map<u32, u32> m_freeRanges;
+    u32 m_capacity;
+    u32 m_used;
+};
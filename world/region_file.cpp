@@ -0,0 +1,614 @@
+#include "region_file.h"
+
+#include "chunk_manager.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr u32 REGION_MAGIC = 0x47525856; // "VXRG"
+    constexpr u32 REGION_VERSION = 1;
+
+    struct RegionHeader {
+        u32 magic;
+        u32 version;
+    };
+
+    // Offset table entries are written straight from RegionFile::TableEntry
+    constexpr u64 TABLE_ENTRY_SIZE = 16;
+    constexpr u64 TABLE_OFFSET = sizeof(RegionHeader);
+    constexpr u64 HEADER_SIZE = TABLE_OFFSET + RegionFile::REGION_COLUMNS * TABLE_ENTRY_SIZE;
+
+    // A run is the voxel followed by its length
+    constexpr std::size_t RUN_SIZE = sizeof(voxel_t) + sizeof(u16);
+
+#ifdef _WIN32
+    int openFile(const std::string& path, RegionAccess access)
+    {
+        if (access == RegionAccess::ReadOnly) {
+            return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+        }
+        return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+    }
+
+    void closeFile(int file)
+    {
+        _close(file);
+    }
+
+    u64 fileSize(int file)
+    {
+        return static_cast<u64>(_filelengthi64(file));
+    }
+
+    // Overlapped reads and writes take their own offset, like pread and pwrite
+    bool readAt(int file, void* data, std::size_t size, u64 offset)
+    {
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file));
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD read = 0;
+        return ReadFile(handle, data, static_cast<DWORD>(size), &read, &overlapped) &&
+               read == size;
+    }
+
+    bool writeAt(int file, const void* data, std::size_t size, u64 offset)
+    {
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file));
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD written = 0;
+        return WriteFile(handle, data, static_cast<DWORD>(size), &written, &overlapped) &&
+               written == size;
+    }
+
+    const char* mapFile(int file, u64 size, void*& mappingHandle)
+    {
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file));
+        HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            return nullptr;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size));
+        if (!view) {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        mappingHandle = mapping;
+        return static_cast<const char*>(view);
+    }
+
+    void unmapFile(const char* mapping, u64, void* mappingHandle)
+    {
+        UnmapViewOfFile(mapping);
+        CloseHandle(mappingHandle);
+    }
+
+    void prefetchRange(const char* data, std::size_t size)
+    {
+#if _WIN32_WINNT >= 0x0602
+        WIN32_MEMORY_RANGE_ENTRY range{const_cast<char*>(data), size};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+        (void)data;
+        (void)size;
+#endif
+    }
+#else
+    int openFile(const std::string& path, RegionAccess access)
+    {
+        if (access == RegionAccess::ReadOnly) {
+            return ::open(path.c_str(), O_RDONLY);
+        }
+        return ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    }
+
+    void closeFile(int file)
+    {
+        ::close(file);
+    }
+
+    u64 fileSize(int file)
+    {
+        struct stat status;
+        return fstat(file, &status) == 0 ? static_cast<u64>(status.st_size) : 0;
+    }
+
+    bool readAt(int file, void* data, std::size_t size, u64 offset)
+    {
+        auto bytes = static_cast<char*>(data);
+        while (size > 0) {
+            ssize_t read = ::pread(file, bytes, size, static_cast<off_t>(offset));
+            if (read <= 0) {
+                return false;
+            }
+            bytes += read;
+            size -= read;
+            offset += read;
+        }
+        return true;
+    }
+
+    bool writeAt(int file, const void* data, std::size_t size, u64 offset)
+    {
+        auto bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t written = ::pwrite(file, bytes, size, static_cast<off_t>(offset));
+            if (written <= 0) {
+                return false;
+            }
+            bytes += written;
+            size -= written;
+            offset += written;
+        }
+        return true;
+    }
+
+    const char* mapFile(int file, u64 size, void*&)
+    {
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+        return mapping == MAP_FAILED ? nullptr : static_cast<const char*>(mapping);
+    }
+
+    void unmapFile(const char* mapping, u64 size, void*)
+    {
+        ::munmap(const_cast<char*>(mapping), size);
+    }
+
+    void prefetchRange(const char* data, std::size_t size)
+    {
+        // madvise wants a page aligned start
+        static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1);
+        size += reinterpret_cast<uintptr_t>(data) - start;
+        ::madvise(reinterpret_cast<void*>(start), size, MADV_WILLNEED);
+    }
+#endif
+
+    template <typename T>
+    void writeValue(std::vector<char>& out, const T& value)
+    {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(const char*& in, const char* end, T& value)
+    {
+        if (static_cast<std::size_t>(end - in) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return true;
+    }
+
+    // Record: chunkX, chunkZ, chunk count, then per chunk its y, run count and runs
+    bool decodeColumn(const char* in, const char* end, LoadedColumn& column)
+    {
+        i32 chunkX, chunkZ;
+        u32 chunkCount;
+        if (!readValue(in, end, chunkX) || !readValue(in, end, chunkZ) ||
+            !readValue(in, end, chunkCount) ||
+            chunkCount > static_cast<std::size_t>(end - in) / (sizeof(i32) + sizeof(u32))) {
+            return false;
+        }
+        column.chunkX = chunkX;
+        column.chunkZ = chunkZ;
+        column.chunkYs.resize(chunkCount);
+        column.chunks.resize(chunkCount);
+
+        for (u32 i = 0; i < chunkCount; i++) {
+            i32 y;
+            u32 runCount;
+            if (!readValue(in, end, y) || !readValue(in, end, runCount) ||
+                static_cast<std::size_t>(end - in) < runCount * RUN_SIZE) {
+                return false;
+            }
+            column.chunkYs[i] = y;
+
+            // Runs are expanded straight into the chunk, stopping at a bad length
+            VoxelArray& voxels = column.chunks[i];
+            u32 voxelCount = 0;
+            for (u32 run = 0; run < runCount; run++) {
+                voxel_t voxel = 0;
+                u16 count = 0;
+                if (!readValue(in, end, voxel) || !readValue(in, end, count) ||
+                    count > CHUNK_VOLUME - voxelCount) {
+                    return false;
+                }
+                std::fill_n(voxels.begin() + voxelCount, count, voxel);
+                voxelCount += count;
+            }
+            if (voxelCount != CHUNK_VOLUME) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int floorDiv(int value, int divisor)
+    {
+        return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+    }
+} // namespace
+
+RegionFile::~RegionFile()
+{
+    close();
+}
+
+bool RegionFile::open(const std::string& path, RegionAccess access)
+{
+    close();
+    m_access = access;
+    m_file = openFile(path, access);
+    if (m_file < 0) {
+        std::cerr << "ERROR::REGION::OPEN_FAILED " << path << std::endl;
+        return false;
+    }
+
+    m_fileSize = fileSize(m_file);
+    m_table.fill({});
+    if (m_fileSize == 0 && access == RegionAccess::ReadWrite) {
+        RegionHeader header{REGION_MAGIC, REGION_VERSION};
+        std::vector<char> empty(HEADER_SIZE, 0);
+        std::memcpy(empty.data(), &header, sizeof(header));
+        if (!writeAt(m_file, empty.data(), empty.size(), 0)) {
+            std::cerr << "ERROR::REGION::WRITE_FAILED " << path << std::endl;
+            close();
+            return false;
+        }
+        m_fileSize = HEADER_SIZE;
+        remap();
+        return true;
+    }
+
+    RegionHeader header{};
+    if (m_fileSize < HEADER_SIZE || !readAt(m_file, &header, sizeof(header), 0) ||
+        header.magic != REGION_MAGIC || header.version != REGION_VERSION ||
+        !readAt(m_file, m_table.data(), sizeof(m_table), TABLE_OFFSET)) {
+        std::cerr << "ERROR::REGION::INVALID_FILE " << path << std::endl;
+        close();
+        return false;
+    }
+    remap();
+    return true;
+}
+
+void RegionFile::close()
+{
+    unmap();
+    if (m_file >= 0) {
+        closeFile(m_file);
+        m_file = -1;
+    }
+}
+
+void RegionFile::unmap()
+{
+    if (m_mapping) {
+        unmapFile(m_mapping, m_mappedSize, m_mappingHandle);
+        m_mapping = nullptr;
+        m_mappedSize = 0;
+        m_mappingHandle = nullptr;
+    }
+}
+
+void RegionFile::remap()
+{
+    unmap();
+    if (m_file >= 0) {
+        m_mapping = mapFile(m_file, m_fileSize, m_mappingHandle);
+        m_mappedSize = m_mapping ? m_fileSize : 0;
+    }
+}
+
+bool RegionFile::hasColumn(int localX, int localZ) const
+{
+    return m_table[localZ * REGION_SIZE + localX].size > 0;
+}
+
+bool RegionFile::refreshColumn(int localX, int localZ)
+{
+    int index = localZ * REGION_SIZE + localX;
+    TableEntry entry;
+    if (m_file < 0 ||
+        !readAt(m_file, &entry, sizeof(entry), TABLE_OFFSET + index * TABLE_ENTRY_SIZE) ||
+        entry.size == 0) {
+        return false;
+    }
+
+    // Records are appended before the table points at them, so the file has grown
+    // over the record unless the entry is torn by a write still in progress
+    u64 size = fileSize(m_file);
+    if (entry.offset < HEADER_SIZE || entry.offset + entry.size > size) {
+        return false;
+    }
+    m_fileSize = std::max(m_fileSize, size);
+    m_table[index] = entry;
+    return true;
+}
+
+bool RegionFile::needsRemap(int localX, int localZ) const
+{
+    const TableEntry& entry = m_table[localZ * REGION_SIZE + localX];
+    return m_mapping && entry.size > 0 && entry.offset + entry.size > m_mappedSize;
+}
+
+void RegionFile::prefetchColumn(int localX, int localZ) const
+{
+    const TableEntry& entry = m_table[localZ * REGION_SIZE + localX];
+    if (entry.size > 0 && entry.offset + entry.size <= m_mappedSize) {
+        prefetchRange(m_mapping + entry.offset, entry.size);
+    }
+}
+
+bool RegionFile::readColumn(int localX, int localZ, LoadedColumn& column) const
+{
+    const TableEntry& entry = m_table[localZ * REGION_SIZE + localX];
+    if (m_file < 0 || entry.size == 0 || entry.offset + entry.size > m_fileSize) {
+        return false;
+    }
+
+    if (entry.offset + entry.size <= m_mappedSize) {
+        const char* record = m_mapping + entry.offset;
+        return decodeColumn(record, record + entry.size, column);
+    }
+
+    std::vector<char> record(entry.size);
+    if (!readAt(m_file, record.data(), record.size(), entry.offset)) {
+        return false;
+    }
+    return decodeColumn(record.data(), record.data() + record.size(), column);
+}
+
+bool RegionFile::writeColumn(int localX, int localZ, const StoredColumn& column)
+{
+    if (m_file < 0 || m_access == RegionAccess::ReadOnly) {
+        return false;
+    }
+
+    std::vector<char> record;
+    writeValue(record, static_cast<i32>(column.chunkX));
+    writeValue(record, static_cast<i32>(column.chunkZ));
+    writeValue(record, static_cast<u32>(column.chunks.size()));
+    for (const StoredColumn::StoredChunk& chunk : column.chunks) {
+        writeValue(record, static_cast<i32>(chunk.y));
+        writeValue(record, static_cast<u32>(chunk.voxels.size()));
+        for (auto [voxel, count] : chunk.voxels) {
+            writeValue(record, voxel);
+            writeValue(record, count);
+        }
+    }
+
+    // The record goes in before the table points at it
+    TableEntry entry;
+    entry.offset = m_fileSize;
+    entry.size = static_cast<u32>(record.size());
+    if (!writeAt(m_file, record.data(), record.size(), entry.offset)) {
+        return false;
+    }
+    m_fileSize += record.size();
+
+    int index = localZ * REGION_SIZE + localX;
+    if (!writeAt(m_file, &entry, sizeof(entry), TABLE_OFFSET + index * TABLE_ENTRY_SIZE)) {
+        return false;
+    }
+    m_table[index] = entry;
+    return true;
+}
+
+RegionStorage::RegionStorage(std::string directory)
+    : m_directory(std::move(directory))
+{
+}
+
+const std::string& RegionStorage::directory() const
+{
+    return m_directory;
+}
+
+RegionAccess RegionStorage::access() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_access;
+}
+
+void RegionStorage::setAccess(RegionAccess access)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (access == m_access) {
+        return;
+    }
+    m_access = access;
+    m_files.clear();
+    m_missingFiles.clear();
+}
+
+RegionFile* RegionStorage::findRegionFile(int regionX, int regionZ) const
+{
+    auto it = m_files.find({regionX, 0, regionZ});
+    return it != m_files.end() ? it->second.get() : nullptr;
+}
+
+RegionFile* RegionStorage::openRegionFile(int regionX, int regionZ, bool create)
+{
+    ChunkPosition key{regionX, 0, regionZ};
+    if (RegionFile* file = findRegionFile(regionX, regionZ)) {
+        return file;
+    }
+    if (!create && isMissingFile(key)) {
+        return nullptr;
+    }
+
+    std::filesystem::path path = std::filesystem::path(m_directory) /
+                                 ("r." + std::to_string(regionX) + "." +
+                                  std::to_string(regionZ) + ".region");
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        if (!create) {
+            markMissingFile(key);
+            return nullptr;
+        }
+        if (!m_directoryCreated) {
+            std::filesystem::create_directories(m_directory, error);
+            m_directoryCreated = true;
+        }
+    }
+
+    auto file = std::make_unique<RegionFile>();
+    if (!file->open(path.string(), m_access)) {
+        markMissingFile(key);
+        return nullptr;
+    }
+    m_missingFiles.erase(key);
+    return m_files.emplace(key, std::move(file)).first->second.get();
+}
+
+bool RegionStorage::isMissingFile(const ChunkPosition& key) const
+{
+    auto it = m_missingFiles.find(key);
+    return it != m_missingFiles.end() && Clock::now() < it->second;
+}
+
+void RegionStorage::markMissingFile(const ChunkPosition& key)
+{
+    m_missingFiles[key] = m_access == RegionAccess::ReadOnly ? Clock::now() + MISSING_FILE_RETRY
+                                                             : Clock::time_point::max();
+}
+
+bool RegionStorage::loadColumn(int chunkX, int chunkZ, LoadedColumn& column)
+{
+    if (m_directory.empty()) {
+        return false;
+    }
+    constexpr int size = RegionFile::REGION_SIZE;
+    int regionX = floorDiv(chunkX, size);
+    int regionZ = floorDiv(chunkZ, size);
+    int localX = chunkX - regionX * size;
+    int localZ = chunkZ - regionZ * size;
+
+    // Usually the file is open and mapped, and loads only share the lock
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        RegionFile* file = findRegionFile(regionX, regionZ);
+        if (file && !file->needsRemap(localX, localZ) &&
+            (file->hasColumn(localX, localZ) || m_access == RegionAccess::ReadWrite)) {
+            return file->readColumn(localX, localZ, column);
+        }
+        if (!file && isMissingFile({regionX, 0, regionZ})) {
+            return false;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    RegionFile* file = openRegionFile(regionX, regionZ, false);
+    if (!file) {
+        return false;
+    }
+    // Another process may have saved the column since the table was read
+    if (m_access == RegionAccess::ReadOnly && !file->hasColumn(localX, localZ) &&
+        !file->refreshColumn(localX, localZ)) {
+        return false;
+    }
+    if (file->needsRemap(localX, localZ)) {
+        file->remap();
+    }
+    return file->readColumn(localX, localZ, column);
+}
+
+bool RegionStorage::saveColumn(const StoredColumn& column)
+{
+    if (m_directory.empty()) {
+        return false;
+    }
+    constexpr int size = RegionFile::REGION_SIZE;
+    int regionX = floorDiv(column.chunkX, size);
+    int regionZ = floorDiv(column.chunkZ, size);
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (m_access == RegionAccess::ReadOnly) {
+        return false;
+    }
+    RegionFile* file = openRegionFile(regionX, regionZ, true);
+    if (!file || !file->writeColumn(column.chunkX - regionX * size,
+                                    column.chunkZ - regionZ * size, column)) {
+        std::cerr << "ERROR::REGION::SAVE_FAILED " << column.chunkX << ", " << column.chunkZ
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void RegionStorage::prefetchColumns(const std::vector<ChunkPosition>& columns)
+{
+    if (m_directory.empty()) {
+        return;
+    }
+    constexpr int size = RegionFile::REGION_SIZE;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (const ChunkPosition& column : columns) {
+        int regionX = floorDiv(column.x, size);
+        int regionZ = floorDiv(column.z, size);
+        int localX = column.x - regionX * size;
+        int localZ = column.z - regionZ * size;
+        RegionFile* file = openRegionFile(regionX, regionZ, false);
+        if (!file) {
+            continue;
+        }
+        if (file->needsRemap(localX, localZ)) {
+            file->remap();
+        }
+        file->prefetchColumn(localX, localZ);
+    }
+}
+
+StoredColumn storeColumn(const ChunkManager& chunkManager, int chunkX, int chunkZ,
+                         const std::vector<int>& chunkYs)
+{
+    StoredColumn column;
+    column.chunkX = chunkX;
+    column.chunkZ = chunkZ;
+
+    VoxelArray voxels;
+    for (int y : chunkYs) {
+        const Chunk* chunk = chunkManager.findChunk({chunkX, y, chunkZ});
+        // All air chunks are what a missing chunk reads as anyway
+        if (!chunk || (chunk->isUniform() && chunk->getVoxel({0, 0, 0}) == 0)) {
+            continue;
+        }
+        chunk->copyVoxels(voxels);
+        column.chunks.push_back({y, compressVoxelData(voxels)});
+    }
+    return column;
+}
+
+std::vector<ChunkPosition> addLoadedColumn(ChunkManager& chunkManager, const LoadedColumn& column)
+{
+    std::vector<ChunkPosition> positions;
+    for (std::size_t i = 0; i < column.chunks.size(); i++) {
+        ChunkPosition position{column.chunkX, column.chunkYs[i], column.chunkZ};
+        chunkManager.addChunk(position).setVoxels(column.chunks[i]);
+        chunkManager.ensureNeighbours(position);
+        positions.push_back(position);
+    }
+    return positions;
+}
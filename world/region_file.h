@@ -0,0 +1,255 @@
+#pragma once
+
+#include "../types.h"
+#include "chunk.h"
+#include "coordinate.h"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ChunkManager;
+
+/**
+ * @brief The chunks of one column as they are kept on disk
+ */
+struct StoredColumn {
+    struct StoredChunk {
+        int y = 0;
+        CompressedVoxels voxels;
+    };
+
+    int chunkX = 0;
+    int chunkZ = 0;
+    std::vector<StoredChunk> chunks;
+};
+
+/**
+ * @brief A column read back from disk, decoded straight into voxel arrays
+ */
+struct LoadedColumn {
+    int chunkX = 0;
+    int chunkZ = 0;
+
+    // chunks[i] holds the voxels of the chunk at chunkYs[i]
+    std::vector<int> chunkYs;
+    std::vector<VoxelArray> chunks;
+};
+
+/**
+ * @brief How region files are opened
+ */
+enum class RegionAccess {
+    // Columns are loaded and saved, files are created when first saved to
+    ReadWrite,
+
+    // Columns are only loaded, for several processes sharing one world directory
+    ReadOnly,
+};
+
+/**
+ * @brief One region file, holding up to REGION_SIZE x REGION_SIZE columns
+ *
+ * The file starts with a table of where each column's record is and how long it
+ * is, followed by the records. Writing a column always appends a new record and
+ * then points the table at it, so a column is either the old or the new version if
+ * the program stops in between. Records that were replaced stay in the file.
+ * Integers are stored in the byte order of the machine.
+ *
+ * The file is also mapped into memory, columns are decoded from the mapping so
+ * processes reading the same world share the page cache. Reads fall back to pread
+ * for records written after the file was mapped, or when it could not be mapped.
+ *
+ * The offset table is read once when the file is opened. A read only file picks up
+ * columns another process saved later through refreshColumn, but a column that was
+ * already stored keeps reading the record it had when it was first seen, until the
+ * file is opened again.
+ */
+class RegionFile final {
+  public:
+    static constexpr int REGION_SIZE = 32;
+    static constexpr int REGION_COLUMNS = REGION_SIZE * REGION_SIZE;
+
+    RegionFile() = default;
+    ~RegionFile();
+
+    RegionFile(const RegionFile&) = delete;
+    RegionFile& operator=(const RegionFile&) = delete;
+
+    /**
+     * @brief Open and map the region file
+     *
+     * @param path Path of the file
+     * @param access ReadWrite creates the file if it does not exist
+     * @return true The file is open
+     */
+    bool open(const std::string& path, RegionAccess access);
+
+    /**
+     * @brief Decode a column from the mapping, or from a single read of its record
+     *
+     * @param localX X of the column within the region, 0 to REGION_SIZE - 1
+     * @param localZ Z of the column within the region, 0 to REGION_SIZE - 1
+     * @param column Column to decode into
+     * @return true The column was stored and could be read
+     */
+    bool readColumn(int localX, int localZ, LoadedColumn& column) const;
+
+    /**
+     * @brief Append a column's record and point the offset table at it
+     *
+     * @param localX X of the column within the region, 0 to REGION_SIZE - 1
+     * @param localZ Z of the column within the region, 0 to REGION_SIZE - 1
+     * @param column The column to write
+     * @return true The column was written
+     */
+    bool writeColumn(int localX, int localZ, const StoredColumn& column);
+
+    bool hasColumn(int localX, int localZ) const;
+
+    /**
+     * @brief Read a column's offset table entry from the file again, for columns
+     * another process may have saved since the table was read
+     *
+     * @param localX X of the column within the region, 0 to REGION_SIZE - 1
+     * @param localZ Z of the column within the region, 0 to REGION_SIZE - 1
+     * @return true The column is stored now
+     */
+    bool refreshColumn(int localX, int localZ);
+
+    /**
+     * @brief Check if a column's record was written after the file was mapped
+     */
+    bool needsRemap(int localX, int localZ) const;
+
+    /**
+     * @brief Map the file again, to cover everything appended to it
+     */
+    void remap();
+
+    /**
+     * @brief Hint that a column will be read soon, so its pages are read ahead
+     *
+     * @param localX X of the column within the region, 0 to REGION_SIZE - 1
+     * @param localZ Z of the column within the region, 0 to REGION_SIZE - 1
+     */
+    void prefetchColumn(int localX, int localZ) const;
+
+  private:
+    struct TableEntry {
+        u64 offset = 0;
+        u32 size = 0;
+        u32 reserved = 0;
+    };
+
+    void close();
+    void unmap();
+
+    int m_file = -1;
+    u64 m_fileSize = 0;
+    RegionAccess m_access = RegionAccess::ReadWrite;
+
+    const char* m_mapping = nullptr;
+    u64 m_mappedSize = 0;
+    // File mapping object on Windows
+    void* m_mappingHandle = nullptr;
+
+    std::array<TableEntry, REGION_COLUMNS> m_table{};
+};
+
+/**
+ * @brief The region files of a world directory
+ * Safe to use from several threads, files are opened when first used. Loads from
+ * different threads decode at the same time, saves wait for them.
+ */
+class RegionStorage final {
+  public:
+    /**
+     * @brief Use a directory for the region files, created on the first write
+     *
+     * @param directory The directory, empty to store nothing
+     */
+    explicit RegionStorage(std::string directory);
+
+    /**
+     * @brief Load a column that was stored before
+     *
+     * @param chunkX X coordinate of the chunk column
+     * @param chunkZ Z coordinate of the chunk column
+     * @param column Column to read into
+     * @return true The column was stored
+     */
+    bool loadColumn(int chunkX, int chunkZ, LoadedColumn& column);
+
+    /**
+     * @brief Store a column, replacing what was stored for it before
+     *
+     * @param column The column to store
+     * @return true The column was written, always false when read only
+     */
+    bool saveColumn(const StoredColumn& column);
+
+    /**
+     * @brief Hint that columns will be loaded soon, so the OS reads their records
+     * into the page cache ahead of time. Columns that are not stored are skipped.
+     *
+     * @param columns Positions of the columns, y is ignored
+     */
+    void prefetchColumns(const std::vector<ChunkPosition>& columns);
+
+    /**
+     * @brief Switch between loading and saving or only loading, closing open files
+     *
+     * @param access How files are opened from now on
+     */
+    void setAccess(RegionAccess access);
+
+    RegionAccess access() const;
+
+    const std::string& directory() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    // How long a read only storage trusts that a region has no file, before
+    // checking the disk again for one another process created
+    static constexpr std::chrono::seconds MISSING_FILE_RETRY{2};
+
+    RegionFile* findRegionFile(int regionX, int regionZ) const;
+    RegionFile* openRegionFile(int regionX, int regionZ, bool create);
+    bool isMissingFile(const ChunkPosition& key) const;
+    void markMissingFile(const ChunkPosition& key);
+
+    std::string m_directory;
+    RegionAccess m_access = RegionAccess::ReadWrite;
+    bool m_directoryCreated = false;
+    std::unordered_map<ChunkPosition, std::unique_ptr<RegionFile>, ChunkPositionHash> m_files;
+    // Regions without a file and when to look for one again, so loads there don't
+    // check the disk every time. Only expires when read only, as otherwise the
+    // files are created by this storage.
+    ChunkPositionMap<Clock::time_point> m_missingFiles;
+    mutable std::shared_mutex m_mutex;
+};
+
+/**
+ * @brief Compress chunks of the chunk manager into a stored column
+ *
+ * @param chunkX X coordinate of the chunk column
+ * @param chunkZ Z coordinate of the chunk column
+ * @param chunkYs The y of each chunk of the column to store
+ * @return StoredColumn The column
+ */
+StoredColumn storeColumn(const ChunkManager& chunkManager, int chunkX, int chunkZ,
+                         const std::vector<int>& chunkYs);
+
+/**
+ * @brief Adds the chunks of a loaded column to the chunk manager
+ * Loaded chunks replace the voxels of chunks that already exist, as they were saved
+ * with everything generation and edits put in them
+ *
+ * @return std::vector<ChunkPosition> The positions of the column's chunks
+ */
+std::vector<ChunkPosition> addLoadedColumn(ChunkManager& chunkManager, const LoadedColumn& column);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer and one consumer thread
+ * The producer only writes the tail and the consumer only writes the head, so
+ * neither ever waits on the other. Push fails when the queue is full.
+ */
+template <typename T>
+class SpscQueue final {
+  public:
+    /**
+     * @brief Create the queue
+     *
+     * @param capacity How many values it holds, rounded up to a power of two
+     */
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Add a value, only called from the producer thread
+     *
+     * @param value Moved from only if there was room
+     * @return true The value was added
+     */
+    bool tryPush(T& value)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+            return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest value, only called from the consumer thread
+     *
+     * @param value Set to the value if there was one
+     * @return true A value was taken
+     */
+    bool tryPop(T& value)
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    std::vector<T> m_slots;
+    std::size_t m_mask = 0;
+
+    // On separate cache lines so the two threads don't share one
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
@@ -1,8 +1,10 @@
 #include "terrain_generation.h"
 
+#include "batch_noise.h"
 #include "chunk.h"
 #include "chunk_manager.h" 
 #include "voxel_data.h"
+#include <cassert>
 #include <cstring>
 #include <functional>
 #include <glm/gtc/noise.hpp>
@@ -35,6 +37,30 @@ namespace {
         float offset;
     };
 
+    constexpr int MAX_OCTAVES = 8;
+
+    /**
+     * @brief Frequency and amplitude of each octave of a NoiseOptions, computed once
+     * rather than for every chunk
+     */
+    struct NoiseOctaves {
+        std::array<float, MAX_OCTAVES> frequencies{};
+        std::array<float, MAX_OCTAVES> amplitudes{};
+        float totalAmplitude = 0;
+    };
+
+    NoiseOctaves getNoiseOctaves(const NoiseOptions& options)
+    {
+        assert(options.octaves <= MAX_OCTAVES);
+        NoiseOctaves octaves;
+        for (int i = 0; i < options.octaves; i++) {
+            octaves.frequencies[i] = glm::pow(2.0f, static_cast<float>(i));
+            octaves.amplitudes[i] = glm::pow(options.roughness, static_cast<float>(i));
+            octaves.totalAmplitude += octaves.amplitudes[i];
+        }
+        return octaves;
+    }
+
     // THANKS! Karasa and K.jpg for help with this algo
     float rounded(const glm::vec2& coord)
     {
@@ -43,29 +69,44 @@ namespace {
         return b * 0.9f;
     }
 
-    float getNoiseAt(const glm::vec2& voxelPosition, const glm::vec2& chunkPosition,
-                     const NoiseOptions& options, int seed)
+    using NoiseMap = std::array<float, CHUNK_AREA>;
+
+    /**
+     * @brief Fractal noise for every voxel column of a chunk, in the range 0 to 1
+     * Each octave is evaluated for the whole chunk at once with simplexNoiseBatch
+     */
+    void getNoiseMap(const ChunkPosition& position, const NoiseOptions& options,
+                     const NoiseOctaves& octaves, int seed, NoiseMap& values)
     {
-        // Get voxel X/Z positions
-        float voxelX = voxelPosition.x + chunkPosition.x * CHUNK_SIZE;
-        float voxelZ = voxelPosition.y + chunkPosition.y * CHUNK_SIZE;
+        const std::array<float, MAX_OCTAVES>& frequencies = octaves.frequencies;
+        const std::array<float, MAX_OCTAVES>& amplitudes = octaves.amplitudes;
 
-        // Begin iterating through the octaves
-        float value = 0;
-        float accumulatedAmps = 0;
+        NoiseMap xs;
+        NoiseMap ys;
+        NoiseMap noise;
+        values.fill(0.0f);
         for (int i = 0; i < options.octaves; i++) {
-            float frequency = glm::pow(2.0f, i);
-            float amplitude = glm::pow(options.roughness, i);
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                for (int x = 0; x < CHUNK_SIZE; x++) {
+                    float voxelX = x + static_cast<float>(position.x) * CHUNK_SIZE;
+                    float voxelZ = z + static_cast<float>(position.z) * CHUNK_SIZE;
+                    xs[z * CHUNK_SIZE + x] =
+                        seed + voxelX * frequencies[i] / options.smoothness;
+                    ys[z * CHUNK_SIZE + x] =
+                        seed + voxelZ * frequencies[i] / options.smoothness;
+                }
+            }
 
-            float x = voxelX * frequency / options.smoothness;
-            float y = voxelZ * frequency / options.smoothness;
+            simplexNoiseBatch(xs.data(), ys.data(), static_cast<float>(seed), noise.data(),
+                              CHUNK_AREA);
+            for (int j = 0; j < CHUNK_AREA; j++) {
+                values[j] += (noise[j] + 1.0f) / 2.0f * amplitudes[i];
+            }
+        }
 
-            float noise = glm::simplex(glm::vec3{seed + x, seed + y, seed});
-            noise = (noise + 1.0f) / 2.0f;
-            value += noise * amplitude;
-            accumulatedAmps += amplitude;
+        for (float& value : values) {
+            value /= octaves.totalAmplitude;
         }
-        return value / accumulatedAmps;
     }
 
     std::array<int, CHUNK_AREA> createChunkHeightMap(const ChunkPosition& position,
@@ -87,7 +128,12 @@ namespace {
         secondNoise.roughness = 0.45f;
         secondNoise.offset = 0;
 
-        glm::vec2 chunkXZ = {position.x, position.z};
+        NoiseMap noiseMap;
+        NoiseMap noiseMap2;
+        static const NoiseOctaves firstOctaves = getNoiseOctaves(firstNoise);
+        static const NoiseOctaves secondOctaves = getNoiseOctaves(secondNoise);
+        getNoiseMap(position, firstNoise, firstOctaves, seed, noiseMap);
+        getNoiseMap(position, secondNoise, secondOctaves, seed, noiseMap2);
 
         std::array<int, CHUNK_AREA> heightMap;
         for (int z = 0; z < CHUNK_SIZE; z++) {
@@ -98,8 +144,8 @@ namespace {
                 glm::vec2 coord =
                     (glm::vec2{bx, bz} - WORLD_SIZE / 2.0f) / WORLD_SIZE * 2.0f;
 
-                auto noise = getNoiseAt({x, z}, chunkXZ, firstNoise, seed);
-                auto noise2 = getNoiseAt({x, z}, {position.x, position.z}, secondNoise, seed);
+                float noise = noiseMap[z * CHUNK_SIZE + x];
+                float noise2 = noiseMap2[z * CHUNK_SIZE + x];
                 auto island = rounded(coord) * 1.25;
                 float result = noise * noise2;
 
@@ -120,26 +166,25 @@ namespace {
         biomeMapNoise.roughness = 0.5f;
         biomeMapNoise.offset = 18;
 
+        NoiseMap noiseMap;
+        static const NoiseOctaves biomeMapOctaves = getNoiseOctaves(biomeMapNoise);
+        getNoiseMap(position, biomeMapNoise, biomeMapOctaves, seed, noiseMap);
+
         std::array<int, CHUNK_AREA> biomeMap;
-        glm::vec2 chunkXZ = {position.x, position.z};
-        for (int z = 0; z < CHUNK_SIZE; z++) {
-            for (int x = 0; x < CHUNK_SIZE; x++) {
-                auto noise = getNoiseAt({x, z}, chunkXZ, biomeMapNoise, seed);
-                int height = static_cast<int>(noise * biomeMapNoise.amplitude);
-                biomeMap[z * CHUNK_SIZE + x] = height;
-            }
+        for (int i = 0; i < CHUNK_AREA; i++) {
+            biomeMap[i] = static_cast<int>(noiseMap[i] * biomeMapNoise.amplitude);
         }
         return biomeMap;
     }
 
-    void createTerrain(Chunk& chunk, const std::array<int, CHUNK_AREA>& heightMap,
+    void createTerrain(VoxelArray& voxels, int chunkY, const std::array<int, CHUNK_AREA>& heightMap,
                        const VoxelDataManager& voxelData, unsigned seed)
     {
         for (int z = 0; z < CHUNK_SIZE; z++) {
             for (int x = 0; x < CHUNK_SIZE; x++) {
                 int height = heightMap[z * CHUNK_SIZE + x];
                 for (int y = 0; y < CHUNK_SIZE; y++) {
-                    int voxelY = chunk.getPosition().y * CHUNK_SIZE + y;
+                    int voxelY = chunkY * CHUNK_SIZE + y;
                     voxel_t voxel = 0;
 
                     if (voxelY > height) {
@@ -164,7 +209,7 @@ namespace {
                         voxel = voxelData.getVoxelId(CommonVoxel::Stone);
                     }
                     if (voxel > 0) {
-                        chunk.qSetVoxel({x, y, z}, voxel);
+                        voxels[toLocalVoxelIndex({x, y, z})] = voxel;
                     }
                 }
             }
@@ -173,25 +218,64 @@ namespace {
 
 } // namespace
 
-std::vector<ChunkPosition> generateTerrain(ChunkManager& chunkManager, int chunkX,
-                                           int chunkZ, const VoxelDataManager& voxelData,
-                                           int seed, int worldSize)
+GeneratedColumn generateColumn(int chunkX, int chunkZ, const VoxelDataManager& voxelData,
+                               int seed, int worldSize)
 {
     ChunkPosition position{chunkX, 0, chunkZ};
-    std::vector<ChunkPosition> positions;
+    GeneratedColumn column;
+    column.chunkX = chunkX;
+    column.chunkZ = chunkZ;
 
     auto heightMap = createChunkHeightMap(position, worldSize, seed);
     int maxHeight = *std::max_element(heightMap.cbegin(), heightMap.cend());
 
-    for (int y = 0; y < std::max(1, maxHeight / CHUNK_SIZE + 1); y++) {
-        Chunk& chunk = chunkManager.addChunk({chunkX, y, chunkZ});
-        createTerrain(chunk, heightMap, voxelData, seed);
-        chunkManager.ensureNeighbours(chunk.getPosition());
-        positions.emplace_back(chunkX, y, chunkZ);
+    int chunkCount = std::max(1, maxHeight / CHUNK_SIZE + 1);
+    column.chunks.resize(chunkCount);
+    for (int y = 0; y < chunkCount; y++) {
+        VoxelArray& voxels = column.chunks[y];
+        voxels.fill(0);
+        createTerrain(voxels, y, heightMap, voxelData, seed);
+    }
+    return column;
+}
+
+std::vector<ChunkPosition> addGeneratedColumn(ChunkManager& chunkManager,
+                                              const GeneratedColumn& column)
+{
+    std::vector<ChunkPosition> positions;
+    for (int y = 0; y < static_cast<int>(column.chunks.size()); y++) {
+        ChunkPosition position{column.chunkX, y, column.chunkZ};
+        const VoxelArray& generated = column.chunks[y];
+
+        if (!chunkManager.hasChunk(position)) {
+            chunkManager.addChunk(position).setVoxels(generated);
+        }
+        else {
+            // Merge in one repack rather than a palette update per voxel
+            Chunk& chunk = chunkManager.addChunk(position);
+            VoxelArray voxels;
+            chunk.copyVoxels(voxels);
+            for (int i = 0; i < CHUNK_VOLUME; i++) {
+                if (generated[i] > 0) {
+                    voxels[i] = generated[i];
+                }
+            }
+            chunk.setVoxels(voxels);
+        }
+        chunkManager.ensureNeighbours(position);
+        positions.push_back(position);
     }
     return positions;
 }
 
+std::vector<ChunkPosition> generateTerrain(ChunkManager& chunkManager, int chunkX,
+                                           int chunkZ, const VoxelDataManager& voxelData,
+                                           int seed, int worldSize)
+{
+    return addGeneratedColumn(chunkManager,
+                              generateColumn(chunkX, chunkZ, voxelData, seed, worldSize));
+}
+
 float generateSeed(const std::string& input)
 {
     std::hash<std::string> strhash;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include "chunk.h"
 #include "coordinate.h"
 #include "world_constants.h"
 #include <vector>
@@ -9,6 +10,41 @@
 class ChunkManager;
 class VoxelDataManager;
 
+/**
+ * @brief The voxels of one chunk column, generated without touching a ChunkManager
+ * Only depends on its inputs, so columns can be generated on any thread
+ */
+struct GeneratedColumn {
+    int chunkX = 0;
+    int chunkZ = 0;
+
+    // Voxels of the chunks in the column, from chunk y = 0 upwards
+    std::vector<VoxelArray> chunks;
+};
+
+/**
+ * @brief Generate the voxels of a chunk column
+ *
+ * @return GeneratedColumn The generated column
+ */
+GeneratedColumn generateColumn(int chunkX, int chunkZ, const VoxelDataManager& voxelData,
+                               int seed, int worldSize);
+
+/**
+ * @brief Adds the chunks of a generated column to the chunk manager
+ * Only non-air voxels are written into chunks that already exist, same as generating
+ * straight into the manager, so merging columns in the same order gives the same world
+ *
+ * @return std::vector<ChunkPosition> The positions of the column's chunks
+ */
+std::vector<ChunkPosition> addGeneratedColumn(ChunkManager& chunkManager,
+                                              const GeneratedColumn& column);
+
+/**
+ * @brief Generate a chunk column straight into the chunk manager
+ *
+ * @return std::vector<ChunkPosition> The positions of the column's chunks
+ */
 std::vector<ChunkPosition> generateTerrain(ChunkManager& chunkManager, int chunkX,
                                            int chunkZ, const VoxelDataManager& voxelData,
                                            int seed, int worldSize);
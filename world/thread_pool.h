@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads that run submitted jobs in FIFO order
+ * Jobs that have not started when the pool is destroyed are discarded, so
+ * anything a job references must outlive the pool
+ */
+class ThreadPool final {
+  public:
+    /**
+     * @brief Start the worker threads
+     *
+     * @param threadCount How many workers to start, at least 1
+     */
+    explicit ThreadPool(unsigned threadCount = defaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a job to be run on one of the workers
+     *
+     * @param job The job to run
+     */
+    void submit(std::function<void()> job);
+
+    unsigned threadCount() const;
+
+    /**
+     * @brief One worker per hardware thread, leaving one for the render thread
+     *
+     * @return unsigned The default worker count
+     */
+    static unsigned defaultThreadCount();
+
+  private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    bool m_stopping = false;
+};
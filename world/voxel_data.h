@@ -4,7 +4,6 @@
 #include <string>
 
 #include "world_constants.h"
-#include <glad/glad.h>
 #include <unordered_map>
 #include <vector>
 
@@ -50,10 +49,10 @@ struct VoxelData {
     std::string bottomTexture;
     std::string modelPath;  // Path to 3D model file
 
-    // Client only
-    GLuint topTextureId = 0;
-    GLuint sideTextureId = 0;
-    GLuint bottomTextureId = 0;
+    // Client only, layers of the block texture array (see BlockTextureArray)
+    u32 topTextureLayer = 0;
+    u32 sideTextureLayer = 0;
+    u32 bottomTextureLayer = 0;
 
     VoxelMeshStyle meshStyle = VoxelMeshStyle::Voxel;
     VoxelType type = VoxelType::Solid;
@@ -0,0 +1,226 @@
+#include "voxel_edits.h"
+
+#include "chunk.h"
+#include "chunk_manager.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    /**
+     * @brief Run an edit over the chunks a box touches, a row of voxels at a time
+     *
+     * @param skipUniform Given the voxel of a chunk that is all one voxel, or air for
+     * a missing chunk, returns true if the edit can't change the chunk
+     * @param editRow Given a chunk row, the first and last x in it to edit, and the
+     * world position of the row's x = 0, edits the row and returns true if it changed
+     */
+    template <typename SkipUniform, typename EditRow>
+    std::vector<ChunkPosition> editChunks(ChunkManager& chunkManager, const VoxelPosition& min,
+                                          const VoxelPosition& max, SkipUniform skipUniform,
+                                          EditRow editRow)
+    {
+        std::vector<ChunkPosition> changed;
+        if (min.x > max.x || min.y > max.y || min.z > max.z) {
+            return changed;
+        }
+
+        ChunkPosition first = toChunkPosition(min);
+        ChunkPosition last = toChunkPosition(max);
+        VoxelArray voxels;
+        for (int chunkY = first.y; chunkY <= last.y; chunkY++) {
+            for (int chunkZ = first.z; chunkZ <= last.z; chunkZ++) {
+                for (int chunkX = first.x; chunkX <= last.x; chunkX++) {
+                    ChunkPosition position{chunkX, chunkY, chunkZ};
+                    Chunk* chunk = chunkManager.findChunk(position);
+                    voxel_t uniform = 0;
+                    if (!chunk || chunk->isUniform()) {
+                        uniform = chunk ? chunk->getVoxel({0, 0, 0}) : 0;
+                        if (skipUniform(uniform)) {
+                            continue;
+                        }
+                        voxels.fill(uniform);
+                    }
+                    else {
+                        chunk->copyVoxels(voxels);
+                    }
+
+                    int originX = chunkX * CHUNK_SIZE;
+                    int originY = chunkY * CHUNK_SIZE;
+                    int originZ = chunkZ * CHUNK_SIZE;
+                    int x0 = std::max(min.x - originX, 0);
+                    int x1 = std::min(max.x - originX, CHUNK_SIZE - 1);
+                    int y0 = std::max(min.y - originY, 0);
+                    int y1 = std::min(max.y - originY, CHUNK_SIZE - 1);
+                    int z0 = std::max(min.z - originZ, 0);
+                    int z1 = std::min(max.z - originZ, CHUNK_SIZE - 1);
+
+                    bool chunkChanged = false;
+                    for (int y = y0; y <= y1; y++) {
+                        for (int z = z0; z <= z1; z++) {
+                            voxel_t* row = &voxels[y * CHUNK_AREA + z * CHUNK_SIZE];
+                            chunkChanged |= editRow(row, x0, x1, originX, originY + y, originZ + z);
+                        }
+                    }
+                    if (!chunkChanged) {
+                        continue;
+                    }
+
+                    chunkManager.addChunk(position).setVoxels(voxels);
+                    chunkManager.ensureNeighbours(position);
+                    changed.push_back(position);
+                }
+            }
+        }
+        return changed;
+    }
+
+    bool fillRow(voxel_t* begin, int count, voxel_t voxel)
+    {
+        if (std::all_of(begin, begin + count, [voxel](voxel_t v) { return v == voxel; })) {
+            return false;
+        }
+        std::memset(begin, voxel, count);
+        return true;
+    }
+} // namespace
+
+std::vector<ChunkPosition> fillBox(ChunkManager& chunkManager, const VoxelPosition& min,
+                                   const VoxelPosition& max, voxel_t voxel)
+{
+    return editChunks(
+        chunkManager, min, max, [voxel](voxel_t uniform) { return uniform == voxel; },
+        [voxel](voxel_t* row, int x0, int x1, int, int, int) {
+            return fillRow(row + x0, x1 - x0 + 1, voxel);
+        });
+}
+
+std::vector<ChunkPosition> fillSphere(ChunkManager& chunkManager, const VoxelPosition& centre,
+                                      int radius, voxel_t voxel)
+{
+    if (radius < 0) {
+        return {};
+    }
+    VoxelPosition min{centre.x - radius, centre.y - radius, centre.z - radius};
+    VoxelPosition max{centre.x + radius, centre.y + radius, centre.z + radius};
+    const int radiusSquared = radius * radius;
+
+    return editChunks(
+        chunkManager, min, max, [voxel](voxel_t uniform) { return uniform == voxel; },
+        [&](voxel_t* row, int x0, int x1, int originX, int y, int z) {
+            // Each row crosses the sphere in one span
+            int dy = y - centre.y;
+            int dz = z - centre.z;
+            int remaining = radiusSquared - dy * dy - dz * dz;
+            if (remaining < 0) {
+                return false;
+            }
+            int halfWidth = static_cast<int>(std::sqrt(static_cast<float>(remaining)));
+            while ((halfWidth + 1) * (halfWidth + 1) <= remaining) {
+                halfWidth++;
+            }
+            while (halfWidth * halfWidth > remaining) {
+                halfWidth--;
+            }
+            int begin = std::max(centre.x - halfWidth - originX, x0);
+            int end = std::min(centre.x + halfWidth - originX, x1);
+            return begin <= end && fillRow(row + begin, end - begin + 1, voxel);
+        });
+}
+
+std::vector<ChunkPosition> replaceVoxels(ChunkManager& chunkManager, const VoxelPosition& min,
+                                         const VoxelPosition& max, voxel_t from, voxel_t to)
+{
+    if (from == to) {
+        return {};
+    }
+    return editChunks(
+        chunkManager, min, max, [from](voxel_t uniform) { return uniform != from; },
+        [from, to](voxel_t* row, int x0, int x1, int, int, int) {
+            bool changed = false;
+            for (int x = x0; x <= x1; x++) {
+                if (row[x] == from) {
+                    row[x] = to;
+                    changed = true;
+                }
+            }
+            return changed;
+        });
+}
+
+std::vector<ChunkPosition> pasteVoxels(ChunkManager& chunkManager, const VoxelPosition& origin,
+                                       const VoxelBuffer& buffer, bool pasteAir)
+{
+    VoxelPosition max{origin.x + buffer.size.x - 1, origin.y + buffer.size.y - 1,
+                      origin.z + buffer.size.z - 1};
+
+    return editChunks(
+        chunkManager, origin, max, [](voxel_t) { return false; },
+        [&](voxel_t* row, int x0, int x1, int originX, int y, int z) {
+            const voxel_t* source = &buffer.at(originX + x0 - origin.x, y - origin.y, z - origin.z);
+            voxel_t* destination = row + x0;
+            int count = x1 - x0 + 1;
+            if (pasteAir) {
+                if (std::memcmp(destination, source, count) == 0) {
+                    return false;
+                }
+                std::memcpy(destination, source, count);
+                return true;
+            }
+
+            bool changed = false;
+            for (int x = 0; x < count; x++) {
+                if (source[x] != 0 && destination[x] != source[x]) {
+                    destination[x] = source[x];
+                    changed = true;
+                }
+            }
+            return changed;
+        });
+}
+
+VoxelBuffer copyVoxels(const ChunkManager& chunkManager, const VoxelPosition& min,
+                       const VoxelPosition& max)
+{
+    VoxelBuffer buffer;
+    buffer.size = {std::max(max.x - min.x + 1, 0), std::max(max.y - min.y + 1, 0),
+                   std::max(max.z - min.z + 1, 0)};
+    buffer.voxels.assign(static_cast<std::size_t>(buffer.size.x) * buffer.size.y * buffer.size.z, 0);
+    if (buffer.voxels.empty()) {
+        return buffer;
+    }
+
+    ChunkPosition first = toChunkPosition(min);
+    ChunkPosition last = toChunkPosition(max);
+    VoxelArray voxels;
+    for (int chunkY = first.y; chunkY <= last.y; chunkY++) {
+        for (int chunkZ = first.z; chunkZ <= last.z; chunkZ++) {
+            for (int chunkX = first.x; chunkX <= last.x; chunkX++) {
+                const Chunk* chunk = chunkManager.findChunk({chunkX, chunkY, chunkZ});
+                if (!chunk) {
+                    continue;
+                }
+                chunk->copyVoxels(voxels);
+
+                int originX = chunkX * CHUNK_SIZE;
+                int originY = chunkY * CHUNK_SIZE;
+                int originZ = chunkZ * CHUNK_SIZE;
+                int x0 = std::max(min.x - originX, 0);
+                int x1 = std::min(max.x - originX, CHUNK_SIZE - 1);
+                int y0 = std::max(min.y - originY, 0);
+                int y1 = std::min(max.y - originY, CHUNK_SIZE - 1);
+                int z0 = std::max(min.z - originZ, 0);
+                int z1 = std::min(max.z - originZ, CHUNK_SIZE - 1);
+
+                for (int y = y0; y <= y1; y++) {
+                    for (int z = z0; z <= z1; z++) {
+                        std::memcpy(&buffer.at(originX + x0 - min.x, originY + y - min.y,
+                                               originZ + z - min.z),
+                                    &voxels[y * CHUNK_AREA + z * CHUNK_SIZE + x0], x1 - x0 + 1);
+                    }
+                }
+            }
+        }
+    }
+    return buffer;
+}
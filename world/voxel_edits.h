@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../types.h"
+#include "coordinate.h"
+#include "world_constants.h"
+#include <vector>
+
+class ChunkManager;
+
+/**
+ * @brief A box of voxels copied out of the world, to be pasted back in
+ * Laid out like a chunk, x fastest, then z, then y
+ */
+struct VoxelBuffer {
+    VoxelPosition size;
+    std::vector<voxel_t> voxels;
+
+    voxel_t& at(int x, int y, int z)
+    {
+        return voxels[(y * size.z + z) * size.x + x];
+    }
+
+    const voxel_t& at(int x, int y, int z) const
+    {
+        return voxels[(y * size.z + z) * size.x + x];
+    }
+};
+
+// The edits below work a chunk at a time: each touched chunk is unpacked once,
+// written a row of voxels at a time, and repacked once. They return the chunks
+// whose voxels changed, chunks that end up the same are left alone.
+
+/**
+ * @brief Set every voxel in a box
+ *
+ * @param min The lowest corner of the box
+ * @param max The highest corner of the box, inclusive
+ * @param voxel The voxel to fill with
+ * @return std::vector<ChunkPosition> The chunks that changed
+ */
+std::vector<ChunkPosition> fillBox(ChunkManager& chunkManager, const VoxelPosition& min,
+                                   const VoxelPosition& max, voxel_t voxel);
+
+/**
+ * @brief Set every voxel whose centre is within a radius of a voxel's centre
+ *
+ * @param centre The voxel at the centre of the sphere
+ * @param radius The radius in voxels
+ * @param voxel The voxel to fill with
+ * @return std::vector<ChunkPosition> The chunks that changed
+ */
+std::vector<ChunkPosition> fillSphere(ChunkManager& chunkManager, const VoxelPosition& centre,
+                                      int radius, voxel_t voxel);
+
+/**
+ * @brief Change every voxel of one type in a box to another type
+ *
+ * @param min The lowest corner of the box
+ * @param max The highest corner of the box, inclusive
+ * @param from The voxel type to replace
+ * @param to The voxel type to replace it with
+ * @return std::vector<ChunkPosition> The chunks that changed
+ */
+std::vector<ChunkPosition> replaceVoxels(ChunkManager& chunkManager, const VoxelPosition& min,
+                                         const VoxelPosition& max, voxel_t from, voxel_t to);
+
+/**
+ * @brief Copy a voxel buffer into the world
+ *
+ * @param origin Where the buffer's lowest corner goes
+ * @param buffer The voxels to paste
+ * @param pasteAir False to keep the world's voxels where the buffer has air
+ * @return std::vector<ChunkPosition> The chunks that changed
+ */
+std::vector<ChunkPosition> pasteVoxels(ChunkManager& chunkManager, const VoxelPosition& origin,
+                                       const VoxelBuffer& buffer, bool pasteAir = true);
+
+/**
+ * @brief Copy a box of the world out, missing chunks read as air
+ *
+ * @param min The lowest corner of the box
+ * @param max The highest corner of the box, inclusive
+ * @return VoxelBuffer The voxels of the box
+ */
+VoxelBuffer copyVoxels(const ChunkManager& chunkManager, const VoxelPosition& min,
+                       const VoxelPosition& max);
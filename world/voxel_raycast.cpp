@@ -0,0 +1,173 @@
+#include "voxel_raycast.h"
+
+#include "chunk.h"
+#include "chunk_manager.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr int CHUNK_SHIFT = 5;
+    static_assert(1 << CHUNK_SHIFT == CHUNK_SIZE, "Voxels are split into chunks with shifts");
+
+    /**
+     * @brief Reads voxels along a ray, looking a chunk up only when the ray enters it
+     */
+    class ChunkCursor {
+      public:
+        explicit ChunkCursor(const ChunkManager& chunkManager)
+            : m_chunkManager(chunkManager)
+        {
+        }
+
+        voxel_t voxelAt(int x, int y, int z)
+        {
+            ChunkPosition position(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+            if (!m_valid || position != m_position) {
+                m_valid = true;
+                m_position = position;
+                m_chunk = m_chunkManager.findChunk(position);
+                // Missing chunks are air, and single voxel chunks are never unpacked
+                m_uniform = !m_chunk || m_chunk->isUniform();
+                m_uniformVoxel = m_chunk && m_uniform ? m_chunk->qGetVoxel({0, 0, 0}) : 0;
+            }
+            if (m_uniform) {
+                return m_uniformVoxel;
+            }
+            return m_chunk->qGetVoxel({x & (CHUNK_SIZE - 1), y & (CHUNK_SIZE - 1), z & (CHUNK_SIZE - 1)});
+        }
+
+      private:
+        const ChunkManager& m_chunkManager;
+        ChunkPosition m_position;
+        const Chunk* m_chunk = nullptr;
+        bool m_valid = false;
+        bool m_uniform = true;
+        voxel_t m_uniformVoxel = 0;
+    };
+
+    VoxelRayHit castRay(ChunkCursor& cursor, const glm::vec3& origin, const glm::vec3& direction,
+                        float maxDistance, const VoxelRayFilter& filter)
+    {
+        VoxelRayHit result;
+        float length = glm::length(direction);
+        if (length == 0.0f || !std::isfinite(maxDistance) || maxDistance < 0.0f) {
+            return result;
+        }
+        glm::vec3 unit = direction / length;
+
+        const float infinity = std::numeric_limits<float>::infinity();
+        int voxel[3];
+        int step[3];
+        float nextBoundary[3];
+        float boundaryDistance[3];
+        for (int axis = 0; axis < 3; axis++) {
+            voxel[axis] = static_cast<int>(std::floor(origin[axis]));
+            if (unit[axis] > 0.0f) {
+                step[axis] = 1;
+                nextBoundary[axis] = (voxel[axis] + 1 - origin[axis]) / unit[axis];
+                boundaryDistance[axis] = 1.0f / unit[axis];
+            }
+            else if (unit[axis] < 0.0f) {
+                step[axis] = -1;
+                nextBoundary[axis] = (origin[axis] - voxel[axis]) / -unit[axis];
+                boundaryDistance[axis] = -1.0f / unit[axis];
+            }
+            else {
+                step[axis] = 0;
+                nextBoundary[axis] = infinity;
+                boundaryDistance[axis] = infinity;
+            }
+        }
+
+        int enteredAxis = -1;
+        float distance = 0.0f;
+        while (true) {
+            voxel_t type = cursor.voxelAt(voxel[0], voxel[1], voxel[2]);
+            if (filter.stopsAt(type)) {
+                result.hit = true;
+                result.voxel = {voxel[0], voxel[1], voxel[2]};
+                if (enteredAxis >= 0) {
+                    int normal[3] = {0, 0, 0};
+                    normal[enteredAxis] = -step[enteredAxis];
+                    result.normal = {normal[0], normal[1], normal[2]};
+                }
+                result.distance = distance;
+                result.type = type;
+                return result;
+            }
+
+            // Cross whichever voxel boundary is nearest
+            int axis = nextBoundary[0] < nextBoundary[1] ? 0 : 1;
+            axis = nextBoundary[2] < nextBoundary[axis] ? 2 : axis;
+            distance = nextBoundary[axis];
+            if (distance > maxDistance) {
+                return result;
+            }
+            voxel[axis] += step[axis];
+            nextBoundary[axis] += boundaryDistance[axis];
+            enteredAxis = axis;
+        }
+    }
+} // namespace
+
+VoxelRayFilter::VoxelRayFilter()
+{
+    m_stops.fill(false);
+}
+
+VoxelRayFilter VoxelRayFilter::ofTypes(const VoxelDataManager& voxelData,
+                                       std::initializer_list<VoxelType> types)
+{
+    VoxelRayFilter filter;
+    for (const VoxelData& data : voxelData.getVoxelData()) {
+        for (VoxelType type : types) {
+            if (data.type == type) {
+                filter.m_stops[data.id] = true;
+            }
+        }
+    }
+    return filter;
+}
+
+VoxelRayFilter VoxelRayFilter::collidable(const VoxelDataManager& voxelData)
+{
+    VoxelRayFilter filter;
+    for (const VoxelData& data : voxelData.getVoxelData()) {
+        filter.m_stops[data.id] = data.isCollidable;
+    }
+    return filter;
+}
+
+VoxelRayFilter VoxelRayFilter::notAir()
+{
+    VoxelRayFilter filter;
+    filter.m_stops.fill(true);
+    filter.m_stops[0] = false;
+    return filter;
+}
+
+void VoxelRayFilter::setStopsAt(voxel_t voxel, bool stops)
+{
+    m_stops[voxel] = stops;
+}
+
+VoxelRayHit raycastVoxels(const ChunkManager& chunkManager, const glm::vec3& origin,
+                          const glm::vec3& direction, float maxDistance,
+                          const VoxelRayFilter& filter)
+{
+    ChunkCursor cursor(chunkManager);
+    return castRay(cursor, origin, direction, maxDistance, filter);
+}
+
+void raycastVoxels(const ChunkManager& chunkManager, const std::vector<VoxelRay>& rays,
+                   const VoxelRayFilter& filter, std::vector<VoxelRayHit>& hits)
+{
+    // Rays cast together, like an AI's line of sight checks, usually start near
+    // each other, so the cursor often still holds the chunk the next one starts in
+    ChunkCursor cursor(chunkManager);
+    hits.resize(rays.size());
+    for (std::size_t i = 0; i < rays.size(); i++) {
+        const VoxelRay& ray = rays[i];
+        hits[i] = castRay(cursor, ray.origin, ray.direction, ray.maxDistance, filter);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../types.h"
+#include "coordinate.h"
+#include "voxel_data.h"
+#include "world_constants.h"
+#include <array>
+#include <glm/glm.hpp>
+#include <vector>
+
+class ChunkManager;
+
+/**
+ * @brief Which voxel types stop a ray, looked up by voxel id
+ */
+class VoxelRayFilter final {
+  public:
+    /**
+     * @brief Stops at nothing
+     */
+    VoxelRayFilter();
+
+    /**
+     * @brief Stop at voxels of the given types, eg Solid for block picking
+     */
+    static VoxelRayFilter ofTypes(const VoxelDataManager& voxelData,
+                                  std::initializer_list<VoxelType> types);
+
+    /**
+     * @brief Stop at collidable voxels, for line of sight
+     */
+    static VoxelRayFilter collidable(const VoxelDataManager& voxelData);
+
+    /**
+     * @brief Stop at every voxel that is not air
+     */
+    static VoxelRayFilter notAir();
+
+    bool stopsAt(voxel_t voxel) const
+    {
+        return m_stops[voxel];
+    }
+
+    void setStopsAt(voxel_t voxel, bool stops);
+
+  private:
+    std::array<bool, 256> m_stops;
+};
+
+struct VoxelRay {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float maxDistance = 0.0f;
+};
+
+struct VoxelRayHit {
+    bool hit = false;
+    VoxelPosition voxel;
+    // Normal of the face the ray entered through, all 0 if it started inside
+    VoxelPosition normal;
+    // Distance along the normalised direction to where the ray entered the voxel
+    float distance = 0.0f;
+    voxel_t type = 0;
+};
+
+/**
+ * @brief Walk a ray through the voxels it crosses until one stops it
+ * Amanatides and Woo's DDA, stepping from one voxel boundary to the next. Missing
+ * chunks read as air, and chunks of a single voxel type are not unpacked.
+ *
+ * @param origin Where the ray starts, in world space
+ * @param direction Direction of the ray, does not need to be normalised
+ * @param maxDistance How far to walk
+ * @param filter Which voxels stop the ray
+ * @return VoxelRayHit The first voxel the filter stops at, if any
+ */
+VoxelRayHit raycastVoxels(const ChunkManager& chunkManager, const glm::vec3& origin,
+                          const glm::vec3& direction, float maxDistance,
+                          const VoxelRayFilter& filter);
+
+/**
+ * @brief Cast many rays, sharing the chunk lookups of rays that cross the same chunks
+ *
+ * @param rays The rays to cast
+ * @param filter Which voxels stop the rays
+ * @param hits Set to one hit per ray
+ */
+void raycastVoxels(const ChunkManager& chunkManager, const std::vector<VoxelRay>& rays,
+                   const VoxelRayFilter& filter, std::vector<VoxelRayHit>& hits);